@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+// Solves a sweep of scenarios concurrently in one process. The manifest is a
+// YAML file:
+//
+//   base_config: data/config.yaml
+//   output_dir: results/batch
+//   threads: 4                  # scenarios solved at the same time
+//   workers_per_scenario: 2     # CP workers of each scenario
+//   demand_files: [data/demand_15_0.csv, data/demand_15_1.csv]
+//   overrides:                  # crossed with demand_files
+//     - name: two_shuttles
+//       fleet: {num_shuttles: 2}
+//     - name: big_battery
+//       fleet: {num_shuttles: 3, battery_capacity_km: 200}
+//
+// Scenarios are grouped by model skeleton (fleet and horizon), and each group
+// is split into contiguous blocks of at most scenarios / threads. A thread
+// takes one block at a time and solves it in the env of its ModelCache, so
+// only the first scenario of a block builds the skeleton. Each scenario writes <name>.json
+// and <name>.log to output_dir; summary.csv collects one row per scenario.
+// Returns the process exit code.
+int run_batch(const std::string& manifest_path);
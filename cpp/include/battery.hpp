@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Charging power as a piecewise-linear function of the state of charge:
+// breakpoints (SOC as a fraction of capacity, km of range gained per hour)
+// sorted by SOC. Power is interpolated between breakpoints and held flat
+// before the first and after the last one.
+using ChargeCurve = std::vector<std::pair<double, double>>;
+
+double charge_power(const ChargeCurve& curve, double soc_fraction);
+
+// Range gained (whole km) by charging a battery of the given capacity from
+// each integer SOC for 0..max_slots slots, precomputed from a charge curve.
+// Charging stops at capacity; the SOC reached never decreases with the
+// starting SOC or the duration.
+class ChargeTable {
+public:
+    ChargeTable() = default;
+    ChargeTable(const ChargeCurve& curve, int capacity, int slot_minutes, int max_slots);
+
+    int gain(int soc, int slots) const { return values_[index(soc, slots)]; }
+
+    // Flat table for element constraints: entry index(soc, slots)
+    size_t index(int soc, int slots) const { return size_t(soc) * (max_slots_ + 1) + slots; }
+    const std::vector<int>& values() const { return values_; }
+
+    int capacity() const { return capacity_; }
+    int max_slots() const { return max_slots_; }
+
+private:
+    int capacity_ = 0;
+    int max_slots_ = 0;
+    std::vector<int> values_;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "battery.hpp"
+
+namespace YAML { class Node; }
+
+// A vehicle type of the fleet. Shuttles of one type are interchangeable,
+// which the model exploits for symmetry breaking.
+struct ShuttleType {
+    std::string name;
+    int count;
+    int seat_capacity;
+    int battery_capacity;
+    int soc_threshold;
+    std::shared_ptr<const ChargeTable> charging;   // set when a charge curve is configured
+};
+
+// One differently-configured CP search of a portfolio solve
+struct PortfolioMember {
+    std::string search_type;
+    int workers;
+    int random_seed;
+};
+
+// Parameters read from config.yaml. Times are expressed in time_res units,
+// as used by the model; energies in km of range.
+struct ProblemConfig {
+    // Horizon
+    int time_res;
+    int start_time;
+    int end_time;
+    int horizon;
+
+    // Fleet and shuttle specs. seat_capacity, battery_capacity and
+    // soc_threshold are the defaults of fleet types that do not set them;
+    // per-shuttle values come from shuttle_type().
+    int num_shuttles;
+    std::vector<ShuttleType> shuttle_types;
+    std::vector<int> shuttle_type_of;   // type index of each shuttle; shuttles are numbered type by type
+    int seat_capacity;
+    int battery_capacity;
+    int trip_distance;
+    int trip_duration;
+    int min_recharge;
+    int max_recharge;
+    int soc_threshold;
+    int max_tasks;
+
+    // Charge curve; empty for fixed charge bumps (CRGp +capacity/2, CRGf +capacity/6).
+    // With a curve, charges last from their fixed length up to max_charge slots
+    // and gain what the shuttle type's ChargeTable gives.
+    ChargeCurve charge_curve;
+    int max_charge;
+
+    // Pickup window after the requested slot
+    int max_wait;
+
+    // Solver
+    int time_limit;
+    std::string log_verbosity;
+    std::string engine;         // cp, mip, or compare (both, bounds side by side)
+    std::string model_type;     // CP formulation: slots or sequence
+    std::string search_type;
+    int workers;                // 0: let CP Optimizer use all cores
+    std::string parallel_mode;
+    long fail_limit;            // 0: no limit
+    long branch_limit;          // 0: no limit
+    double relative_gap;        // < 0: CP Optimizer default
+    int random_seed;
+    bool aggregate_demand;
+    bool warm_start;
+    bool presolve;              // bound the CP objective before solving; skip the solve if a valid greedy meets it
+    std::string export_model;   // .cpo file the CP model is written to before solving; empty: none
+    bool heuristic_only;        // greedy schedule only, no CP solve
+
+    // Input
+    bool demand_cache;          // keep parsed demand in <demand file>.cache
+
+    // Large-neighborhood search, within time_limit overall
+    bool lns;
+    int lns_iterations;
+    int lns_iteration_time_limit;
+    int lns_window;
+
+    // Rolling-horizon decomposition: overlapping windows solved in turn
+    bool rolling_horizon;
+    int window_length;
+    int window_overlap;
+    int window_time_limit;
+
+    // Portfolio: members race on copies of the model, sharing incumbents between rounds
+    bool portfolio;
+    int portfolio_rounds;
+    std::vector<PortfolioMember> portfolio_members;
+
+    // Re-planning daemon
+    int replan_time_limit;      // seconds per re-solve after a demand update
+};
+
+// Copy of cfg restricted to [start_time, end_time), with max_tasks resized to match
+ProblemConfig with_horizon(const ProblemConfig& cfg, int start_time, int end_time);
+
+// Copy of cfg whose fleet is the given shuttles of cfg, renumbered in that order
+ProblemConfig with_shuttles(const ProblemConfig& cfg, const std::vector<int>& shuttles);
+
+// Copy of cfg with a fleet of n shuttles of the default spec
+ProblemConfig with_fleet_size(const ProblemConfig& cfg, int n);
+
+inline const ShuttleType& shuttle_type(const ProblemConfig& cfg, int shuttle) {
+    return cfg.shuttle_types[cfg.shuttle_type_of[shuttle]];
+}
+
+ProblemConfig load_config(const std::string& path);
+ProblemConfig parse_config(const YAML::Node& config);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class Direction { Outbound, Return };
+
+// Parses "OUTBOUND" / "RETURN"; throws std::invalid_argument otherwise
+Direction parse_direction(const std::string& name);
+const char* direction_name(Direction direction);
+
+struct DemandRequest {
+    int req_id;
+    Direction direction;
+    double time;
+};
+
+// Per-request format only: req_id,direction,time with time in model slots
+std::vector<DemandRequest> load_demand_csv(const std::string& filename);
+
+// Loads either demand format, told apart by the header (columns in any order):
+//   req_id,direction,time        one row per request, time in model slots
+//   slot,direction,passengers    passengers per 30-minute slot, expanded to one
+//                                request per passenger and sorted by time
+// Directions are OUTBOUND/RETURN or O/R. Malformed rows throw
+// std::runtime_error naming the file and line. With use_cache the parsed
+// requests are also kept in <path>.cache and reused while the CSV's size,
+// modification time (to the nanosecond) and time_res are unchanged.
+std::vector<DemandRequest> load_demand(const std::string& path, int time_res, bool use_cache = false);
+
+// Writes the req_id,direction,time format read by load_demand_csv
+void write_demand_csv(const std::string& filename, const std::vector<DemandRequest>& demands);
+
+// Passengers sharing a direction and requested slot. They are interchangeable
+// for the model, which only decides how many of them board each task.
+struct DemandGroup {
+    Direction direction;
+    int slot;
+    std::vector<size_t> members;   // indices into the demand list, in input order
+};
+
+std::vector<DemandGroup> group_demands(const std::vector<DemandRequest>& demands);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "schedule.hpp"
+
+// Greedy constructive dispatcher. Repeatedly takes the shuttle that frees up
+// first and gives it its next task under the same transition rules, SOC limits
+// and horizon as the CP model: bring a shuttle that is away back on the next
+// return window, charge when the battery cannot cover a round trip (or while
+// idle before the next request), otherwise leave on the next outbound window
+// or to pick up return passengers. Passengers board earliest-request-first up
+// to seat capacity. Does not depend on CPLEX; runs in milliseconds.
+Schedule greedy_schedule(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                         const std::vector<ShuttleState>& states = {});
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Streaming JSON emitter: values go straight to the stream, with commas and
+// indentation handled from a stack of open containers. Non-finite doubles
+// are written as null.
+class JsonWriter {
+public:
+    // indent 0 writes everything on one line
+    explicit JsonWriter(std::ostream& out, int indent = 2);
+
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    JsonWriter& begin_array();
+    JsonWriter& end_array();
+
+    // Inside an object, each value must be preceded by its key
+    JsonWriter& key(const std::string& name);
+
+    JsonWriter& value(int v);
+    JsonWriter& value(long v);
+    JsonWriter& value(long long v);
+    JsonWriter& value(unsigned long v);
+    JsonWriter& value(double v);
+    JsonWriter& value(bool v);
+    JsonWriter& value(const char* v);
+    JsonWriter& value(const std::string& v);
+    JsonWriter& null();
+
+    template <class T>
+    JsonWriter& field(const std::string& name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+    // Writes the next containers on one line, e.g. for small records in a long array
+    void set_compact(bool compact) { compact_ = compact; }
+
+private:
+    void before_value();
+    void newline();
+    void write_string(const std::string& v);
+
+    struct Level {
+        bool object;
+        size_t count;
+    };
+
+    std::ostream& out_;
+    int indent_;
+    bool compact_ = false;
+    bool after_key_ = false;
+    std::vector<Level> stack_;
+    std::vector<bool> compact_stack_;
+};
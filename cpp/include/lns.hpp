@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ilcp/cp.h>
+#include <ostream>
+
+#include "config.hpp"
+#include "model.hpp"
+
+// Large-neighborhood search over an extracted model. Each iteration fixes the
+// incumbent everywhere except one or two shuttles, or except a time window,
+// re-solves the freed part with a short time limit and keeps the result only
+// if it improves. Neighborhoods are drawn with adaptive weights rewarding
+// recent improvements.
+//
+// Starts from the first solution of cp (which may carry a starting point),
+// searched for within cfg.time_limit, and returns false if there is none.
+// Each iteration is limited to lns_iteration_time_limit and to the time left.
+// On success, incumbent holds the best solution and objective its value.
+bool run_lns(IloCP& cp, ShuttleModel& sm, const ProblemConfig& cfg, IloSolution& incumbent, double& objective,
+             std::ostream& log);
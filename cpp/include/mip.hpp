@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ilcplex/ilocplex.h>
+#include <ostream>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "schedule.hpp"
+
+struct MipResult {
+    bool found = false;
+    double objective = 0;
+    double bound = 0;           // best MIP bound
+    double lp_bound = 0;        // LP relaxation, solved before the MIP
+    double solve_time = 0;
+    Schedule schedule;
+};
+
+// Time-indexed network-flow MIP over the same inputs and objective weights as
+// the CP model, solved with CPLEX. Integer shuttle flow of each shuttle type
+// runs through that type's time-expanded network from build_network();
+// integer boarding variables per (demand group, departure slot) are limited
+// by the seats of the trips departing in that slot. Shuttles of a type are
+// aggregated and task slots are not
+// counted, so the MIP relaxes the CP model slightly and its bounds are valid
+// lower bounds for it. Only fresh shuttles (no carried-over state) are
+// supported.
+MipResult solve_mip(IloEnv env, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                    std::ostream& log);
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <ilcp/cp.h>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "preprocess.hpp"
+#include "profile.hpp"
+#include "schedule.hpp"
+
+inline TaskMode trip_mode(Direction direction) {
+    return direction == Direction::Outbound ? TaskMode::OUT : TaskMode::RET;
+}
+
+// Interval variables of every (shuttle, task, mode) in one contiguous array.
+// Each slot stores its five mode intervals followed by the master interval S.
+// In the sequence model slot i of a mode holds the shuttle's i-th pool interval
+// of that mode; END and S are unused and pools may be shorter than the grid.
+class TaskGrid {
+public:
+    TaskGrid() = default;
+    TaskGrid(int num_shuttles, int max_tasks)
+        : num_shuttles_(num_shuttles), max_tasks_(max_tasks),
+          vars_(size_t(num_shuttles) * max_tasks * STRIDE) {}
+
+    IloIntervalVar& operator()(int q, int i, TaskMode mode) {
+        return vars_[offset(q, i) + static_cast<int>(mode)];
+    }
+    const IloIntervalVar& operator()(int q, int i, TaskMode mode) const {
+        return vars_[offset(q, i) + static_cast<int>(mode)];
+    }
+    IloIntervalVar& master(int q, int i) { return vars_[offset(q, i) + NUM_TASK_MODES]; }
+    const IloIntervalVar& master(int q, int i) const { return vars_[offset(q, i) + NUM_TASK_MODES]; }
+
+    // False for grid entries the model did not create
+    bool has(int q, int i, TaskMode mode) const { return (*this)(q, i, mode).getImpl() != nullptr; }
+
+    int num_shuttles() const { return num_shuttles_; }
+    int max_tasks() const { return max_tasks_; }
+
+private:
+    static constexpr int STRIDE = NUM_TASK_MODES + 1;
+
+    size_t offset(int q, int i) const { return (size_t(q) * max_tasks_ + i) * STRIDE; }
+
+    int num_shuttles_ = 0;
+    int max_tasks_ = 0;
+    std::vector<IloIntervalVar> vars_;
+};
+
+// CP model of one scheduling instance together with the handles needed to
+// search it and read a solution back.
+struct ShuttleModel {
+    IloModel model;
+    IloObjective objective;
+    TaskGrid tasks;
+
+    // Sequence model: one interval sequence per shuttle over its task pools
+    bool sequence = false;
+    IloIntervalSequenceVarArray sequences;
+
+    // Demand items are single passengers, or (direction, slot) groups when aggregated
+    bool aggregated = false;
+    std::vector<DemandGroup> groups;
+    std::vector<TripWindow> windows;
+    std::vector<int> item_size;
+
+    // One assignment variable per arc: boolean per passenger, boarded count per group
+    AssignmentIndex assign_index;
+    std::vector<IloIntVar> assign;
+
+    // Trip flag for each shuttle/task slot (slot model only)
+    std::vector<IloBoolVar> trip_flags;
+
+    IloIntervalVarArray all_intervals;
+    IloIntVarArray assign_vars;
+};
+
+// Slot-model part that does not depend on the demand: task intervals, trip
+// bounds, transitions, chaining, idle tails, the SOC function, symmetry
+// breaking and the trip flags. Fixed by the fleet, the horizon and the
+// shuttles' opening states.
+struct ModelSkeleton {
+    IloModel model;
+    TaskGrid tasks;
+    std::vector<TaskBounds> bounds;
+    std::vector<IloBoolVar> trip_flags;
+    IloIntervalVarArray all_intervals;
+};
+
+// Hash of everything a skeleton is built from
+uint64_t skeleton_key(const ProblemConfig& cfg, const std::vector<ShuttleState>& states);
+
+// Skeletons of repeated runs in one process, kept in an IloEnv owned by the
+// cache. A run on next_env() whose key is cached only builds its demand layer
+// into a new model holding the skeleton. Every run leaves its demand layer in
+// the env, so the env and its skeletons are dropped after max_runs runs.
+// Not thread-safe: one cache per thread.
+class ModelCache {
+public:
+    explicit ModelCache(int max_runs = 16);
+    ~ModelCache();
+
+    ModelCache(const ModelCache&) = delete;
+    ModelCache& operator=(const ModelCache&) = delete;
+
+    // Environment for the next run
+    IloEnv next_env();
+    IloEnv env() const { return env_; }
+
+    const ModelSkeleton* find(uint64_t key) const;
+    const ModelSkeleton& insert(uint64_t key, const ModelSkeleton& skeleton);
+
+private:
+    IloEnv env_;
+    int max_runs_;
+    int runs_ = 0;
+    std::map<uint64_t, ModelSkeleton> skeletons_;
+};
+
+// Builds the CP model over [cfg.start_time, cfg.end_time]. Shuttles start from
+// the given states, or fresh (at the hub, full battery) when none are given.
+// With a profiler, each constraint family is timed and sized.
+//
+// cfg.model_type selects the formulation. "slots" gives every shuttle
+// max_tasks slots of five optional mode intervals under an alternative, with
+// pairwise transition constraints between neighbouring slots. "sequence" gives
+// every shuttle demand-sized pools of optional trips and charges on an
+// IloIntervalSequenceVar with a no-overlap constraint; the transition rules are
+// stated on the interval types of the sequence and there are no END tasks.
+//
+// With a cache whose env is env, the slot model's skeleton is taken from or
+// added to the cache.
+ShuttleModel build_model(IloEnv env, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                         const std::vector<ShuttleState>& states = {}, Profiler* profiler = nullptr,
+                         ModelCache* cache = nullptr);
+
+// Partial starting point placing each shuttle's hint tasks on its first slots
+// (slot model) or on its first pool intervals of each mode (sequence model)
+IloSolution make_starting_point(IloEnv env, const ShuttleModel& sm,
+                                const std::vector<std::vector<ScheduledTask>>& hint);
+
+// Full starting point from a complete schedule (e.g. the greedy heuristic's):
+// tasks on their slots plus the assignment values of every arc
+IloSolution make_starting_point(IloEnv env, const ShuttleModel& sm, const Schedule& schedule);
+
+// Present tasks and request assignments of the current solution. Group counts
+// are handed out to group members in request order.
+Schedule extract_schedule(const IloCP& cp, const ShuttleModel& sm, size_t num_demands);
+Schedule extract_schedule(const IloSolution& solution, const ShuttleModel& sm, size_t num_demands);
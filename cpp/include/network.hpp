@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "config.hpp"
+#include "schedule.hpp"
+
+// Where a shuttle is between tasks, and which tasks the transition rules still
+// allow: after a RET anything; initially and after a CRGp only an OUT; after
+// a CRGf an OUT or another CRGf; away only a RET.
+enum class Location : int { Hub, HubOutOnly, HubCharging, Away };
+constexpr int NUM_LOCATIONS = 4;
+
+// One unit of arc flow is one shuttle waiting a slot or performing a task
+struct NetworkArc {
+    int from;
+    int to;
+    bool wait;
+    TaskMode mode;      // the task performed, unless wait
+    int start;
+    int end;
+};
+
+// Time-expanded network of shuttle states (time, location, SOC level) over
+// [cfg.start_time, cfg.end_time] for fresh shuttles of one type. SOC is
+// discretised in the gcd of the trip and charge deltas, so every state of
+// the CP model is represented exactly. Arcs obey the CP model's transition
+// rules and SOC limits; only states reachable from the start and from which
+// a shuttle can still end the day at the hub are kept.
+struct TimeExpandedNetwork {
+    int first_time;
+    int last_time;
+    int soc_unit;
+    int levels;                 // SOC levels 0..levels-1, in soc_unit
+    int source;                 // all shuttles start here
+    std::vector<NetworkArc> arcs;
+    std::vector<std::vector<int>> out_arcs;   // per node
+    std::vector<std::vector<int>> in_arcs;
+
+    int node(int time, Location location, int level) const {
+        return ((time - first_time) * NUM_LOCATIONS + int(location)) * levels + level;
+    }
+    size_t num_nodes() const { return out_arcs.size(); }
+};
+
+// Network of the shuttles sharing the type of cfg's shuttle `shuttle`
+TimeExpandedNetwork build_network(const ProblemConfig& cfg, int shuttle);
+
+// Splits an integer flow (one value per arc, cfg.num_shuttles leaving the
+// source) into one task list per shuttle, closed with END like the CP
+// model's
+std::vector<std::vector<ScheduledTask>> decompose_flow(const TimeExpandedNetwork& net, const ProblemConfig& cfg,
+                                                       const std::vector<int>& flow);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "solver.hpp"
+
+// Races cfg.portfolio_members, each an IloCP with its own search type, worker
+// count and seed, in parallel threads. Concert environments are not shared
+// between threads, so every member builds its own copy of the model. The
+// time limit is split into cfg.portfolio_rounds rounds. Members publish every
+// incumbent from a solution callback as soon as it is found. Each solve starts
+// from the best schedule of any member, with a constraint that the objective
+// be no worse than it, since a starting point alone does not bound the
+// objective. A member whose search falls behind another member's incumbent
+// aborts and restarts early under the tighter cutoff. All members stop as soon
+// as one proves optimality (or the best bound closes the gap) or the time
+// limit expires.
+SolveResult solve_portfolio(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands, std::ostream& log);
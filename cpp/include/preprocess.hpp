@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "demand.hpp"
+#include "schedule.hpp"
+
+// Start-time bounds of a trip at each task index of one shuttle. Every non-END
+// task lasts at least one trip, and the transition rules (an OUT is always
+// followed by a RET, the END comes by the last slot) limit which indices can
+// host each direction and how late they can start.
+struct TaskBounds {
+    std::vector<int> out_earliest, out_latest;
+    std::vector<int> ret_earliest, ret_latest;
+
+    // True if a trip in the given direction at task index i can start in [lo, hi]
+    bool allows(Direction direction, int i, int lo, int hi) const;
+};
+
+TaskBounds compute_task_bounds(const ShuttleState& state, int end_time, int trip_duration, int max_tasks);
+
+// Time window in which a request (or demand group) must be picked up
+struct TripWindow {
+    Direction direction;
+    int earliest;
+    int latest;
+};
+
+// Task pools of one shuttle in the sequence model: optional round trips (an
+// OUT immediately followed by its RET) and charges, used in index order.
+// Round k's trips may board passengers; its index is the "task" of the
+// shuttle's assignment arcs.
+struct TaskPools {
+    bool lone_return = false;   // round 0 is a RET without OUT: the shuttle starts away
+    int rounds = 0;
+    int partial_charges = 0;
+    int full_charges = 0;
+
+    int size() const { return std::max({rounds, partial_charges, full_charges}); }
+};
+
+// Pools sized from the demand rather than from the horizon. A round trip that
+// boards nobody only adds cost, so apart from one repositioning round every
+// round boards inside some item's window, one trip after the previous one at
+// the earliest. Charges are bounded by the energy the battery can take in.
+TaskPools size_task_pools(const ShuttleState& state, const ProblemConfig& cfg, int shuttle,
+                          const std::vector<TripWindow>& items);
+
+// Trip start bounds of each round of a shuttle's pools, padded to `size` rounds
+TaskBounds compute_round_bounds(const ShuttleState& state, int end_time, int trip_duration,
+                                const TaskPools& pools, int size);
+
+// Sparse (shuttle, task, item) assignment pattern. Only pairs whose trip can
+// reach the item's window get an arc; arcs are listed per task slot and per item.
+struct AssignmentIndex {
+    struct Arc {
+        int shuttle;
+        int task;
+        int item;
+    };
+
+    int max_tasks = 0;
+    std::vector<Arc> arcs;
+    std::vector<std::vector<int>> by_task;   // shuttle * max_tasks + task -> arc ids
+    std::vector<std::vector<int>> by_item;   // item -> arc ids
+
+    const std::vector<int>& task_arcs(int shuttle, int task) const {
+        return by_task[size_t(shuttle) * max_tasks + task];
+    }
+};
+
+AssignmentIndex build_assignment_index(const std::vector<TaskBounds>& bounds, int max_tasks,
+                                       const std::vector<TripWindow>& items);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "schedule.hpp"
+
+// Bounds that hold for every schedule of a fresh fleet over the full horizon,
+// computed without CPLEX before the CP solve:
+//   - round trips per shuttle, from the horizon, max_tasks and the energy the
+//     battery holds plus what it can take in while not driving
+//   - passengers each direction can board, from seat capacity per departure
+//     slot (every shuttle leaves at most once per slot) and the round trips
+//   - trips needed to carry the remaining passengers, from groups of
+//     overlapping pickup windows that no single trip can span
+// Direction-indexed arrays are [outbound, return].
+struct PresolveBounds {
+    bool feasible = true;
+    std::string reason;                  // why no schedule exists, if !feasible
+
+    std::vector<int> max_round_trips;    // per shuttle
+    int requests[2] = {0, 0};
+    int slot_capacity = 0;               // seats leaving per slot and direction
+    int peak_demand[2] = {0, 0};         // most passengers requesting one slot
+    int overloaded_slots[2] = {0, 0};    // slots requesting more than slot_capacity
+    int max_served[2] = {0, 0};
+    int out_of_window = 0;               // requests no trip inside the horizon can pick up
+
+    int min_unmet = 0;
+    int min_trips = 0;
+    double objective = 0;                // lower bound on the CP objective
+};
+
+PresolveBounds presolve_bounds(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands);
+
+void print_presolve_report(const PresolveBounds& bounds, std::ostream& out);
+
+// Value of the CP objective (waiting time, unmet demand, trips) for a schedule
+double schedule_objective(const Schedule& schedule, const std::vector<DemandRequest>& demands);
+
+// First rule of the CP model the schedule breaks for shuttles opening in the
+// given states (fresh when none are given), or "" if it keeps them all: the
+// first task and the transitions, the slot layout (at most max_tasks tasks,
+// closed by a single END that runs to the end of the horizon), task lengths
+// and the horizon, the SOC limits, and the windows and seats of the boarded
+// passengers
+std::string schedule_violation(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                               const Schedule& schedule, const std::vector<ShuttleState>& states = {});
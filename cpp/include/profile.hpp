@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Peak resident set size of the process so far, in MB
+double peak_rss_mb();
+
+struct PhaseRecord {
+    std::string name;
+    int depth;                  // nesting level, 0 for top-level phases
+    double start;               // seconds since the profiler was created
+    double seconds;
+    double peak_rss_mb;         // high-water mark at the end of the phase
+    long constraints = -1;      // model size added by the phase, -1 if not sized
+    long variables = -1;
+};
+
+// Solver progress: a new incumbent or a tightened bound
+struct TracePoint {
+    double time;                // seconds since the profiler was created
+    bool has_objective;
+    double objective;
+    double bound;
+};
+
+// Wall-clock phase timings, memory high-water marks, model size per
+// constraint family and the incumbent trace of one run. Not thread-safe:
+// use one profiler per solve.
+class Profiler {
+public:
+    Profiler();
+
+    // Opens a nested phase; returns its index for end() and set_size()
+    size_t begin(const std::string& name);
+    void end(size_t phase);
+    void set_size(size_t phase, long constraints, long variables);
+
+    void add_trace_point(bool has_objective, double objective, double bound);
+
+    double elapsed() const;
+    const std::vector<PhaseRecord>& phases() const { return phases_; }
+    const std::vector<TracePoint>& trace() const { return trace_; }
+
+    // Indented table of phases with time, memory and model size
+    void report(std::ostream& out) const;
+    // {"phases": [...], "trace": [...]}
+    void write_json(const std::string& path) const;
+
+private:
+    std::chrono::steady_clock::time_point t0_;
+    std::vector<PhaseRecord> phases_;
+    std::vector<TracePoint> trace_;
+    int depth_ = 0;
+};
+
+// Times the enclosing scope as one phase; inert with a null profiler
+class ScopedPhase {
+public:
+    ScopedPhase(Profiler* profiler, const std::string& name);
+    ~ScopedPhase() { stop(); }
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    // Ends the phase early; later calls do nothing
+    void stop();
+
+private:
+    Profiler* profiler_;
+    size_t phase_ = 0;
+    bool open_ = false;
+};
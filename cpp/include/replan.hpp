@@ -0,0 +1,133 @@
+#pragma once
+
+#include <ilcp/cp.h>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "model.hpp"
+#include "schedule.hpp"
+
+// Live re-planning over one operating day. The session keeps the demand set,
+// the current plan and one CP model of the whole day, extracted once into an
+// IloCP that lives as long as the session. Demand deltas are applied in
+// memory; replan() brings the model up to date and re-solves it:
+//   - tasks that started before now are fixed to the plan by bound changes,
+//     and the other tasks may not start before now
+//   - only the requests added, removed or modified since the last re-plan
+//     get their assignment variables and constraints added or removed
+//   - a shuttle taken out of service boards nobody on its open trips
+// Each solve starts from the incumbent of the previous one, so a re-solve
+// usually only repairs it. The model is always the slot model with one
+// assignment per passenger, so that a delta touches only its own request.
+class ReplanSession {
+public:
+    ReplanSession(const ProblemConfig& cfg, std::vector<DemandRequest> demands, std::ostream& log);
+    ~ReplanSession();
+
+    ReplanSession(const ReplanSession&) = delete;
+    ReplanSession& operator=(const ReplanSession&) = delete;
+
+    // Demand deltas, taking effect at the next replan(). Throw
+    // std::invalid_argument for unknown or duplicate ids, and for requests
+    // already picked up.
+    void add_request(const DemandRequest& req);
+    void remove_request(int req_id);
+    void modify_request(const DemandRequest& req);
+
+    // Takes a shuttle out of service. The tasks it has already started are kept,
+    // and so is its return to base if it is away; it boards nobody new.
+    void set_unavailable(int shuttle);
+
+    // Moves the clock forward (slots); tasks starting before now are frozen
+    void advance(int now);
+
+    // Re-solves within cfg.replan_time_limit. Returns false and keeps the
+    // previous plan if no solution was found.
+    bool replan();
+
+    const ProblemConfig& config() const { return cfg_; }
+    int now() const { return now_; }
+    const std::vector<DemandRequest>& demands() const { return demands_; }
+    // Current plan; served_by follows the order of demands()
+    Schedule schedule() const;
+
+private:
+    // Assignment layer of one request: a boolean per trip slot that can pick
+    // it up, its unmet and waiting-time variables and their constraints
+    struct RequestModel {
+        DemandRequest req;
+        std::vector<std::pair<int, int>> trips;   // (shuttle, slot) of each assignment
+        IloIntVarArray assign;
+        IloIntVar unmet;
+        IloIntVar wait;
+        IloConstraintArray constraints;
+        bool in_incumbent = false;
+    };
+
+    // Seat limit of one (shuttle, slot, direction) over the requests that can board there
+    struct SeatLimit {
+        std::map<int, IloIntVar> riders;   // req_id -> assignment
+        IloConstraint limit;
+    };
+    using SeatKey = std::tuple<int, int, Direction>;
+
+    // Leading tasks of shuttle q that started before now
+    size_t frozen_tasks(int q) const;
+    bool picked_up(int req_id) const;
+    size_t find_request(int req_id) const;
+
+    // Model upkeep before each solve
+    void build_model_once();
+    void freeze_started_tasks();
+    void retire_shuttles();
+    void sync_requests();
+    void add_request_model(const DemandRequest& req);
+    void remove_request_model(int req_id);
+    void update_seat_limit(const SeatKey& key);
+    void update_objective();
+    void read_solution();
+
+    ProblemConfig cfg_;
+    std::vector<DemandRequest> demands_;
+    std::vector<std::vector<ScheduledTask>> plan_;
+    std::map<int, std::pair<int, int>> served_;   // req_id -> (shuttle, position in plan_)
+    std::vector<bool> in_service_;
+    int now_;
+    std::ostream& log_;
+
+    IloEnv env_;
+    bool built_ = false;
+    ShuttleModel sm_;
+    IloCP cp_;
+    IloSolution incumbent_;
+    bool has_incumbent_ = false;
+    std::vector<TaskBounds> bounds_;
+    std::map<int, RequestModel> requests_;                 // by req_id
+    std::map<SeatKey, SeatLimit> seat_limits_;
+    std::vector<std::vector<ScheduledTask>> solved_;       // the model's plan, out-of-service shuttles included
+    std::vector<size_t> frozen_;                           // slots fixed in the model, per shuttle
+    std::vector<int> retired_;                             // tasks kept by an out-of-service shuttle, -1 in service
+};
+
+// Line protocol for a session, one command per line on in, one reply line on
+// out ("ok ..." or "error ..."):
+//
+//   add <req_id> <OUTBOUND|RETURN> <slot>
+//   modify <req_id> <OUTBOUND|RETURN> <slot>
+//   remove <req_id>
+//   unavailable <shuttle>
+//   now <slot>
+//   solve                 re-plan after the deltas above
+//   schedule              prints the plan, then "ok"
+//   write <solution.json>
+//   quit
+//
+// A local socket can be attached with e.g. socat UNIX-LISTEN:<path> EXEC:...
+// Returns when in is exhausted or on quit.
+void run_daemon(ReplanSession& session, std::istream& in, std::ostream& out);
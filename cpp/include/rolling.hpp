@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "schedule.hpp"
+
+// Solves [cfg.start_time, cfg.end_time] as a sequence of overlapping windows of
+// cfg.window_length, each with its own IloEnv and cfg.window_time_limit.
+// Tasks starting before the next window opens are committed and fix the
+// shuttle states (availability, SOC, last task) the next window starts from;
+// the uncommitted tail of each window seeds the next one as a starting point.
+Schedule solve_rolling_horizon(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                               std::ostream& log);
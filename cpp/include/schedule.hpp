@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+
+// Modes a task slot can take; exactly one is present per slot
+enum class TaskMode : int { OUT, RET, CRGp, CRGf, END };
+
+constexpr int NUM_TASK_MODES = 5;
+constexpr TaskMode ALL_TASK_MODES[NUM_TASK_MODES] = {
+    TaskMode::OUT, TaskMode::RET, TaskMode::CRGp, TaskMode::CRGf, TaskMode::END};
+
+const char* task_mode_name(TaskMode mode);
+
+// Transition rules between consecutive task slots of a shuttle:
+// OUT -> RET; RET -> OUT, CRGp, CRGf, END; CRGp -> OUT; CRGf -> OUT, CRGf.
+// END closes the list; END -> END only lets a shuttle whose previous task was
+// END stay idle.
+bool can_follow(TaskMode prev, TaskMode next);
+
+// SOC change of a task on the given shuttle: trips consume trip_distance,
+// charges add a fixed share of that shuttle's battery
+int soc_delta(TaskMode mode, const ProblemConfig& cfg, int shuttle);
+
+// Range a charge of the given mode and length (slots) adds from soc on the
+// shuttle: from its type's charge table with a charge curve, otherwise the
+// fixed soc_delta bump
+int charge_gain(TaskMode mode, int soc, int length, const ProblemConfig& cfg, int shuttle);
+
+// State of a shuttle when a planning horizon opens. A fresh shuttle is at the
+// hub with a full battery and must start with an OUT.
+struct ShuttleState {
+    int available_from;
+    int soc;
+    bool has_prev = false;
+    TaskMode prev_mode = TaskMode::END;   // last task already performed, if has_prev
+
+    bool allows_first(TaskMode mode) const {
+        return has_prev ? can_follow(prev_mode, mode) : mode == TaskMode::OUT;
+    }
+};
+
+std::vector<ShuttleState> initial_states(const ProblemConfig& cfg);
+
+struct ScheduledTask {
+    TaskMode mode;
+    int slot;       // task index on the shuttle
+    int start;
+    int end;
+};
+
+// SOC change of a scheduled task on the shuttle, starting from soc
+int task_soc_delta(const ScheduledTask& t, int soc, const ProblemConfig& cfg, int shuttle);
+
+// Solver-independent view of a solution: tasks per shuttle in time order, and
+// the (shuttle, position in that shuttle's task list) serving each request.
+struct Schedule {
+    std::vector<std::vector<ScheduledTask>> shuttles;
+    std::vector<std::pair<int, int>> served_by;   // (-1, -1) if unmet
+};
+
+// Close a shuttle's task list with END, as the model does: a single END is the
+// idle tail from `from` to the end of the horizon, and the slots after it up
+// to cfg.max_tasks stay empty
+void pad_with_end(std::vector<ScheduledTask>& tasks, int from, const ProblemConfig& cfg);
+
+// SOC of one shuttle over its task list, from initial_soc at cfg.start_time.
+// As in the model's cumul function, trips draw their energy when they start
+// and charges add theirs when they end. One (time, soc) point per change.
+std::vector<std::pair<int, int>> soc_timeline(const std::vector<ScheduledTask>& tasks, const ProblemConfig& cfg,
+                                              int shuttle, int initial_soc);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "schedule.hpp"
+
+// Human-readable task list per shuttle
+void print_schedule(std::ostream& out, const ProblemConfig& cfg, const Schedule& schedule);
+
+// solution.json: parameters; per shuttle its tasks (with SOC before/after and
+// the req_ids on board) and SOC timeline as [time, soc] points; per-passenger
+// assignments; and the req_ids left unmet.
+void write_solution_json(const std::string& path, const ProblemConfig& cfg,
+                         const std::vector<DemandRequest>& demands, const Schedule& schedule);
+
+// Columnar form of a schedule: one entry per task and one per request.
+// Unmet requests have served_shuttle, served_slot and departure -1. Modes and
+// directions use the TaskMode and Direction enum order.
+struct SolutionColumns {
+    std::vector<int32_t> shuttle, slot, start, end, soc_start, soc_end;
+    std::vector<uint8_t> mode;
+    std::vector<double> req_time;
+    std::vector<int32_t> req_id, served_shuttle, served_slot, departure;
+    std::vector<uint8_t> direction;
+};
+
+SolutionColumns solution_columns(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                                 const Schedule& schedule);
+
+// Columnar binary layout for large outputs, native byte order:
+//   char[4] "MBSL", uint32 version,
+//   int32 num_shuttles, time_res, start_time, end_time, battery_capacity,
+//         trip_distance, seat_capacity, trip_duration,
+//   uint64 num_tasks, num_requests,
+//   tasks:    int32 shuttle[], slot[], start[], end[], soc_start[], soc_end[], uint8 mode[]
+//   requests: float64 req_time[], int32 req_id[], shuttle[], slot[], departure[],
+//             uint8 direction[]
+// in the order of SolutionColumns.
+constexpr char SOLUTION_MAGIC[4] = {'M', 'B', 'S', 'L'};
+constexpr uint32_t SOLUTION_VERSION = 1;
+void write_solution_binary(const std::string& path, const ProblemConfig& cfg,
+                           const std::vector<DemandRequest>& demands, const Schedule& schedule);
+
+// Binary for a .bin path, JSON otherwise
+void write_solution(const std::string& path, const ProblemConfig& cfg,
+                    const std::vector<DemandRequest>& demands, const Schedule& schedule);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ilcp/cp.h>
+#include <ostream>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "model.hpp"
+#include "profile.hpp"
+#include "schedule.hpp"
+
+// Search phases and solver parameters from the configuration: time limit,
+// workers, parallel mode, search type, log verbosity, fail/branch limits,
+// relative gap and seed. Throws std::invalid_argument on unknown names.
+void configure_solver(IloCP& cp, const ShuttleModel& sm, const ProblemConfig& cfg);
+
+// Search statistics after a solve: status, objective and bound, gap, and the
+// branch/fail/choice-point counters, in total and averaged over the workers
+// the search used (Concert does not break them down per worker).
+void print_solve_report(const IloCP& cp, const ProblemConfig& cfg, std::ostream& out);
+
+struct SolveResult {
+    bool found = false;
+    bool has_objective = false;   // rolling-horizon and heuristic runs have no single CP objective
+    double objective = 0;
+    bool has_bound = false;
+    double bound = 0;             // best proven lower bound on the objective
+    double solve_time = 0;        // seconds, including model build
+    Schedule schedule;            // empty task lists when nothing was found
+};
+
+// Runs the configured pipeline on one instance: greedy heuristic only, rolling
+// horizon, LNS, a portfolio of CP searches, a single CP solve warm-started
+// from the greedy schedule, or the MIP formulation (solver.engine). With engine "compare" the CP and MIP
+// are both solved, their bounds are reported, and the CP result is returned.
+// With solver.presolve, the CP solve is preceded by the bounds of presolve.hpp:
+// it is skipped when the fleet cannot be feasible or the greedy schedule keeps
+// the model's rules (schedule_violation) and meets the bound, and otherwise the
+// bound is added to the model as a cut on the objective. With
+// solver.export_model the CP model is always built and written to a .cpo file;
+// a greedy schedule meeting the bound is then its starting point. Progress and the CP log go to log. With a profiler, the build and solve
+// phases are timed and every incumbent/bound improvement is traced. With a
+// cache (env must be its env), the model's skeleton is shared with earlier runs.
+SolveResult solve_problem(IloEnv env, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                          std::ostream& log, Profiler* profiler = nullptr, ModelCache* cache = nullptr);
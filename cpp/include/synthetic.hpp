@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include "demand.hpp"
+
+// Shape of a generated demand profile. Times are slots in [first_slot,
+// last_slot]. A share of the passengers clusters around one outbound and one
+// return peak (normal around the peak centre); the rest is spread uniformly.
+struct SyntheticDemandSpec {
+    int passengers = 100;
+    int first_slot = 0;
+    int last_slot = 23;
+    double return_share = 0.5;     // fraction of RETURN requests
+    double peak_share = 0.6;       // fraction of requests drawn from the peaks
+    double outbound_peak = 0.25;   // peak centres, as fractions of the span
+    double return_peak = 0.75;
+    double peak_width = 2.0;       // standard deviation in slots
+    unsigned seed = 1;
+};
+
+// Requests sorted by time, with req_id in that order. Deterministic for a
+// given spec.
+std::vector<DemandRequest> generate_demand(const SyntheticDemandSpec& spec);
@@ -0,0 +1,180 @@
+#include "batch.hpp"
+
+#include <ilcp/cp.h>
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "model.hpp"
+#include "schedule.hpp"
+#include "solution.hpp"
+#include "solver.hpp"
+
+namespace {
+
+struct Scenario {
+    std::string name;
+    std::string demand_file;
+    std::pair<std::string, int> demand_key;   // (file, time_res)
+    uint64_t skeleton = 0;                    // skeleton_key of the fresh fleet
+    ProblemConfig cfg;
+
+    // Filled by the worker
+    bool ok = false;
+    std::string error;
+    SolveResult result;
+    int served = 0;
+    int trips = 0;
+};
+
+// Recursively overlays the keys of override_node onto base (a clone)
+void merge_into(YAML::Node base, const YAML::Node& override_node) {
+    for (auto it = override_node.begin(); it != override_node.end(); ++it) {
+        std::string key = it->first.as<std::string>();
+        if (it->second.IsMap() && base[key] && base[key].IsMap())
+            merge_into(base[key], it->second);
+        else
+            base[key] = YAML::Clone(it->second);
+    }
+}
+
+} // namespace
+
+int run_batch(const std::string& manifest_path) {
+    namespace fs = std::filesystem;
+
+    YAML::Node manifest = YAML::LoadFile(manifest_path);
+    YAML::Node base = YAML::LoadFile(manifest["base_config"].as<std::string>());
+    fs::path output_dir = manifest["output_dir"] ? manifest["output_dir"].as<std::string>() : "results/batch";
+    fs::create_directories(output_dir);
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    int workers = manifest["workers_per_scenario"] ? manifest["workers_per_scenario"].as<int>() : 1;
+    int threads = manifest["threads"] ? manifest["threads"].as<int>() : std::max(1, int(cores) / workers);
+    if (unsigned(threads * workers) > cores)
+        std::cerr << "Warning: " << threads << " threads x " << workers << " workers exceeds "
+                  << cores << " cores." << std::endl;
+
+    // Demand files are parsed once per time resolution and shared read-only by the scenarios
+    std::map<std::pair<std::string, int>, std::vector<DemandRequest>> demand_cache;
+    std::vector<Scenario> scenarios;
+    YAML::Node overrides = manifest["overrides"];
+    size_t num_overrides = overrides ? overrides.size() : 1;
+    for (size_t o = 0; o < num_overrides; ++o) {
+        for (const auto& file_node : manifest["demand_files"]) {
+            std::string demand_file = file_node.as<std::string>();
+            YAML::Node config = YAML::Clone(base);
+            std::string name = "base";
+            if (overrides) {
+                YAML::Node ov = YAML::Clone(overrides[o]);
+                name = ov["name"] ? ov["name"].as<std::string>() : "override" + std::to_string(o);
+                ov.remove("name");
+                merge_into(config, ov);
+            }
+
+            Scenario sc;
+            sc.name = name + "__" + fs::path(demand_file).stem().string();
+            sc.demand_file = demand_file;
+            sc.cfg = parse_config(config);
+            sc.cfg.workers = workers;
+            sc.cfg.log_verbosity = "Quiet";
+            sc.demand_key = {demand_file, sc.cfg.time_res};
+            sc.skeleton = skeleton_key(sc.cfg, initial_states(sc.cfg));
+            if (!demand_cache.count(sc.demand_key))
+                demand_cache[sc.demand_key] = load_demand(demand_file, sc.cfg.time_res, sc.cfg.demand_cache);
+            scenarios.push_back(sc);
+        }
+    }
+    std::cout << "Batch: " << scenarios.size() << " scenarios on " << threads << " threads, "
+              << workers << " CP workers each." << std::endl;
+
+    // Threads take whole blocks of scenarios with the same skeleton, so that
+    // only the first scenario of a block builds it in the thread's cache.
+    // Blocks hold at most an even share of the batch, leaving every thread work.
+    std::vector<std::vector<size_t>> groups;
+    std::map<uint64_t, size_t> group_of;
+    for (size_t k = 0; k < scenarios.size(); ++k) {
+        auto it = group_of.emplace(scenarios[k].skeleton, groups.size()).first;
+        if (it->second == groups.size())
+            groups.emplace_back();
+        groups[it->second].push_back(k);
+    }
+    size_t block_size = std::max<size_t>(1, (scenarios.size() + threads - 1) / threads);
+    std::vector<std::vector<size_t>> blocks;
+    for (const auto& group : groups)
+        for (size_t begin = 0; begin < group.size(); begin += block_size)
+            blocks.emplace_back(group.begin() + begin, group.begin() + std::min(group.size(), begin + block_size));
+
+    std::atomic<size_t> next(0);
+    std::mutex console;
+    auto worker = [&]() {
+        ModelCache cache;
+        for (size_t b = next++; b < blocks.size(); b = next++) {
+            for (size_t k : blocks[b]) {
+                Scenario& sc = scenarios[k];
+                const auto& demands = demand_cache.at(sc.demand_key);
+                std::ofstream log(output_dir / (sc.name + ".log"));
+
+                IloEnv env = cache.next_env();
+                try {
+                    sc.result = solve_problem(env, sc.cfg, demands, log, nullptr, &cache);
+                    write_solution_json((output_dir / (sc.name + ".json")).string(), sc.cfg, demands, sc.result.schedule);
+                    sc.ok = true;
+                } catch (IloException& e) {
+                    sc.error = e.getMessage();
+                } catch (std::exception& e) {
+                    sc.error = e.what();
+                }
+
+                for (const auto& served : sc.result.schedule.served_by)
+                    sc.served += served.first >= 0;
+                for (const auto& tasks : sc.result.schedule.shuttles)
+                    for (const auto& t : tasks)
+                        sc.trips += t.mode == TaskMode::OUT || t.mode == TaskMode::RET;
+
+                std::lock_guard<std::mutex> lock(console);
+                std::cout << "[" << k + 1 << "/" << scenarios.size() << "] " << sc.name << ": "
+                          << (sc.ok ? (sc.result.found ? "solved" : "no solution") : "error: " + sc.error)
+                          << " in " << sc.result.solve_time << " s" << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back(worker);
+    for (auto& t : pool)
+        t.join();
+
+    // Summary table
+    std::ofstream summary(output_dir / "summary.csv");
+    summary << "scenario,demand_file,status,requests,served,trips,objective,solve_time" << std::endl;
+    std::cout << std::left << std::setw(40) << "scenario" << std::setw(12) << "status"
+              << std::setw(10) << "served" << std::setw(8) << "trips" << std::setw(14) << "objective"
+              << "time (s)" << std::endl;
+    int failures = 0;
+    for (const Scenario& sc : scenarios) {
+        std::string status = !sc.ok ? "error" : (sc.result.found ? "solved" : "infeasible");
+        failures += !sc.ok;
+        size_t requests = demand_cache.at(sc.demand_key).size();
+        std::string objective = sc.result.has_objective ? std::to_string(sc.result.objective) : "";
+
+        summary << sc.name << "," << sc.demand_file << "," << status << "," << requests << ","
+                << sc.served << "," << sc.trips << "," << objective << "," << sc.result.solve_time << std::endl;
+        std::cout << std::left << std::setw(40) << sc.name << std::setw(12) << status
+                  << std::setw(10) << (std::to_string(sc.served) + "/" + std::to_string(requests))
+                  << std::setw(8) << sc.trips << std::setw(14) << objective
+                  << sc.result.solve_time << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#include "battery.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+double charge_power(const ChargeCurve& curve, double soc_fraction) {
+    if (curve.empty())
+        return 0;
+    if (soc_fraction <= curve.front().first)
+        return curve.front().second;
+    for (size_t k = 1; k < curve.size(); ++k) {
+        const auto& a = curve[k-1];
+        const auto& b = curve[k];
+        if (soc_fraction <= b.first)
+            return b.first > a.first ? a.second + (b.second - a.second) * (soc_fraction - a.first) / (b.first - a.first)
+                                     : b.second;
+    }
+    return curve.back().second;
+}
+
+ChargeTable::ChargeTable(const ChargeCurve& curve, int capacity, int slot_minutes, int max_slots)
+    : capacity_(capacity), max_slots_(max_slots) {
+    if (capacity <= 0 || slot_minutes <= 0 || max_slots < 0)
+        throw std::invalid_argument("ChargeTable: capacity, slot length and charge length must be positive");
+    for (size_t k = 0; k < curve.size(); ++k)
+        if (curve[k].second < 0 || (k > 0 && curve[k].first < curve[k-1].first))
+            throw std::invalid_argument("ChargeTable: charge curve must have sorted SOC and non-negative power");
+
+    // Hours to charge from empty to each whole km, integrating 1/power with the
+    // midpoint rule; infinite once the curve's power drops to zero
+    const int steps = 16;
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> hours(capacity + 1, 0.0);
+    for (int s = 1; s <= capacity; ++s) {
+        double dt = 0;
+        for (int i = 0; i < steps; ++i) {
+            double power = charge_power(curve, (s - 1 + (i + 0.5) / steps) / capacity);
+            dt += power > 0 ? 1.0 / (steps * power) : inf;
+        }
+        hours[s] = hours[s-1] + dt;
+    }
+
+    // Highest km reachable within each duration, one pass per starting SOC
+    values_.resize(size_t(capacity + 1) * (max_slots + 1));
+    for (int soc = 0; soc <= capacity; ++soc) {
+        int reached = soc;
+        for (int d = 0; d <= max_slots; ++d) {
+            double budget = hours[soc] + d * slot_minutes / 60.0 + 1e-9;
+            while (reached < capacity && hours[reached + 1] <= budget)
+                ++reached;
+            values_[index(soc, d)] = reached - soc;
+        }
+    }
+}
@@ -0,0 +1,224 @@
+// Benchmark harness: solves synthetic instances over a grid of fleet sizes,
+// horizon lengths and passenger counts, and appends one CSV row per instance
+// so that runs from different commits can be compared.
+//
+//   bench config.yaml results.csv [--shuttles 2,3,4] [--slots 24,48]
+//         [--passengers 100,200,400] [--time-limit 30] [--repeats 1] [--seed 1]
+//         [--peak-share 0.6]
+//
+// Each instance runs in a forked child so that peak RSS is per instance.
+#include <ilcp/cp.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "heuristic.hpp"
+#include "model.hpp"
+#include "profile.hpp"
+#include "solver.hpp"
+#include "synthetic.hpp"
+
+#ifndef BENCH_COMMIT
+#define BENCH_COMMIT "unknown"
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+std::vector<int> parse_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string cell;
+    while (std::getline(ss, cell, ','))
+        values.push_back(std::stoi(cell));
+    return values;
+}
+
+struct BenchPoint {
+    int shuttles;
+    int slots;
+    int passengers;
+    unsigned seed;
+};
+
+const char* CSV_HEADER =
+    "commit,shuttles,slots,passengers,seed,parse_s,build_s,variables,constraints,"
+    "first_solution_s,solutions,objective,gap,served,solve_s,peak_rss_mb";
+
+// Generates, parses, builds and solves one instance; returns its CSV row
+std::string run_point(const ProblemConfig& base, const BenchPoint& point, double peak_share,
+                      const std::string& demand_path) {
+    ProblemConfig cfg = with_horizon(base, base.start_time, base.start_time + point.slots);
+    cfg = with_fleet_size(cfg, point.shuttles);
+    cfg.log_verbosity = "Quiet";
+    cfg.lns = cfg.rolling_horizon = cfg.heuristic_only = false;
+
+    SyntheticDemandSpec spec;
+    spec.passengers = point.passengers;
+    spec.first_slot = cfg.start_time;
+    spec.last_slot = cfg.end_time - cfg.trip_duration;
+    spec.peak_share = peak_share;
+    spec.seed = point.seed;
+    write_demand_csv(demand_path, generate_demand(spec));
+
+    auto t0 = Clock::now();
+    std::vector<DemandRequest> demands = load_demand_csv(demand_path);
+    double parse_s = seconds_since(t0);
+
+    IloEnv env;
+    t0 = Clock::now();
+    ShuttleModel sm = build_model(env, cfg, demands);
+    double build_s = seconds_since(t0);
+
+    IloCP cp(sm.model);
+    configure_solver(cp, sm, cfg);
+    cp.setOut(env.getNullStream());
+    if (cfg.warm_start)
+        cp.setStartingPoint(make_starting_point(env, sm, greedy_schedule(cfg, demands)));
+
+    // Enumerate improving solutions to time the first one
+    t0 = Clock::now();
+    cp.startNewSearch();
+    double first_solution_s = -1;
+    int solutions = 0;
+    double objective = 0;
+    IloSolution incumbent(env);
+    incumbent.add(sm.all_intervals);
+    incumbent.add(sm.assign_vars);
+    while (cp.next()) {
+        if (solutions++ == 0)
+            first_solution_s = seconds_since(t0);
+        objective = cp.getObjValue();
+        incumbent.store(cp);
+    }
+    double solve_s = seconds_since(t0);
+    int served = 0;
+    if (solutions > 0)
+        for (const auto& s : extract_schedule(incumbent, sm, demands.size()).served_by)
+            served += s.first >= 0;
+    double gap = -1;
+    if (solutions > 0) {
+        double bound = cp.getObjBound();
+        gap = objective != 0 ? std::fabs(objective - bound) / std::fabs(objective) : 0.0;
+    }
+
+    std::ostringstream row;
+    row << BENCH_COMMIT << "," << point.shuttles << "," << point.slots << "," << point.passengers << ","
+        << point.seed << "," << parse_s << "," << build_s << ","
+        << cp.getInfo(IloCP::NumberOfVariables) << "," << cp.getInfo(IloCP::NumberOfConstraints) << ","
+        << first_solution_s << "," << solutions << "," << (solutions > 0 ? std::to_string(objective) : "") << ","
+        << gap << "," << served << "," << solve_s << ",";
+    cp.endSearch();
+    cp.end();
+    env.end();
+    row << peak_rss_mb();
+    return row.str();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " config.yaml results.csv [--shuttles 2,3,4] [--slots 24,48]"
+                  << " [--passengers 100,200,400] [--time-limit 30] [--repeats 1] [--seed 1] [--peak-share 0.6]"
+                  << std::endl;
+        return 1;
+    }
+
+    ProblemConfig base = load_config(argv[1]);
+    std::string results_path = argv[2];
+    std::vector<int> shuttles = {base.num_shuttles};
+    std::vector<int> slots = {base.horizon};
+    std::vector<int> passengers = {100, 200, 400};
+    int repeats = 1;
+    unsigned seed = 1;
+    double peak_share = 0.6;
+    base.time_limit = 30;
+
+    for (int a = 3; a + 1 < argc; a += 2) {
+        std::string flag = argv[a];
+        std::string value = argv[a + 1];
+        if (flag == "--shuttles") shuttles = parse_list(value);
+        else if (flag == "--slots") slots = parse_list(value);
+        else if (flag == "--passengers") passengers = parse_list(value);
+        else if (flag == "--time-limit") base.time_limit = std::stoi(value);
+        else if (flag == "--repeats") repeats = std::stoi(value);
+        else if (flag == "--seed") seed = unsigned(std::stoul(value));
+        else if (flag == "--peak-share") peak_share = std::stod(value);
+        else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Rows accumulate across runs; write the header only for a new file
+    bool new_file = !std::ifstream(results_path).good();
+    std::ofstream results(results_path, std::ios::app);
+    if (new_file)
+        results << CSV_HEADER << std::endl;
+    std::string demand_path = results_path + ".demand.csv";
+    std::cout << CSV_HEADER << std::endl;
+
+    for (int q : shuttles)
+        for (int h : slots)
+            for (int p : passengers)
+                for (int r = 0; r < repeats; ++r) {
+                    BenchPoint point{q, h, p, seed + unsigned(r)};
+
+                    // The child reports its row through a pipe
+                    int fd[2];
+                    if (pipe(fd) != 0) {
+                        std::perror("pipe");
+                        return 1;
+                    }
+                    pid_t pid = fork();
+                    if (pid == 0) {
+                        close(fd[0]);
+                        std::string row;
+                        try {
+                            row = run_point(base, point, peak_share, demand_path);
+                        } catch (IloException& e) {
+                            std::cerr << "Concert exception: " << e.getMessage() << std::endl;
+                        } catch (std::exception& e) {
+                            std::cerr << "Error: " << e.what() << std::endl;
+                        }
+                        ssize_t written = write(fd[1], row.data(), row.size());
+                        close(fd[1]);
+                        _exit(written == ssize_t(row.size()) && !row.empty() ? 0 : 1);
+                    }
+                    close(fd[1]);
+                    std::string row;
+                    char buffer[256];
+                    ssize_t n;
+                    while ((n = read(fd[0], buffer, sizeof(buffer))) > 0)
+                        row.append(buffer, size_t(n));
+                    close(fd[0]);
+                    int status = 0;
+                    waitpid(pid, &status, 0);
+
+                    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || row.empty()) {
+                        std::cerr << "Instance " << q << " shuttles, " << h << " slots, " << p
+                                  << " passengers failed." << std::endl;
+                        continue;
+                    }
+                    results << row << std::endl;
+                    std::cout << row << std::endl;
+                }
+
+    std::remove(demand_path.c_str());
+    return 0;
+}
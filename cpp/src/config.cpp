@@ -0,0 +1,174 @@
+#include "config.hpp"
+
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+ProblemConfig load_config(const std::string& path) {
+    return parse_config(YAML::LoadFile(path));
+}
+
+namespace {
+
+void build_charge_tables(ProblemConfig& cfg) {
+    for (auto& type : cfg.shuttle_types)
+        type.charging = cfg.charge_curve.empty() ? nullptr
+            : std::make_shared<const ChargeTable>(cfg.charge_curve, type.battery_capacity, cfg.time_res, cfg.max_charge);
+}
+
+} // namespace
+
+ProblemConfig parse_config(const YAML::Node& config) {
+    ProblemConfig cfg;
+
+    // Horizon keys may live under a "time" section or at the top level
+    YAML::Node time = config["time"] ? config["time"] : config;
+    cfg.time_res = time["time_res"].as<int>();
+    cfg.start_time = time["start_time"].as<int>() / cfg.time_res;
+    cfg.end_time = time["end_time"].as<int>() / cfg.time_res;
+    cfg.horizon = cfg.end_time - cfg.start_time;
+
+    YAML::Node fleet = config["fleet"];
+    cfg.num_shuttles = fleet["num_shuttles"] ? fleet["num_shuttles"].as<int>() : 0;
+    cfg.seat_capacity = fleet["seat_capacity"].as<int>();
+    cfg.battery_capacity = fleet["battery_capacity_km"].as<int>();
+    cfg.trip_distance = fleet["trip_distance_km"].as<int>();
+    cfg.trip_duration = fleet["trip_duration_min"].as<int>() / cfg.time_res;
+    cfg.min_recharge = fleet["min_partial_minutes"].as<int>() / cfg.time_res;
+    cfg.max_recharge = fleet["min_full_minutes"].as<int>() / cfg.time_res;
+    cfg.soc_threshold = fleet["soc_threshold"].as<int>();
+
+    // Heterogeneous fleet: vehicle types override the default spec
+    if (fleet["types"]) {
+        for (const auto& type : fleet["types"]) {
+            cfg.shuttle_types.push_back({
+                type["name"] ? type["name"].as<std::string>() : "type" + std::to_string(cfg.shuttle_types.size()),
+                type["count"].as<int>(),
+                type["seat_capacity"] ? type["seat_capacity"].as<int>() : cfg.seat_capacity,
+                type["battery_capacity_km"] ? type["battery_capacity_km"].as<int>() : cfg.battery_capacity,
+                type["soc_threshold"] ? type["soc_threshold"].as<int>() : cfg.soc_threshold});
+            if (cfg.shuttle_types.back().count < 0)
+                throw std::invalid_argument("fleet: negative count for type " + cfg.shuttle_types.back().name);
+        }
+    } else {
+        cfg.shuttle_types.push_back({"default", cfg.num_shuttles, cfg.seat_capacity, cfg.battery_capacity,
+                                     cfg.soc_threshold});
+    }
+    for (size_t k = 0; k < cfg.shuttle_types.size(); ++k)
+        cfg.shuttle_type_of.insert(cfg.shuttle_type_of.end(), cfg.shuttle_types[k].count, int(k));
+    cfg.num_shuttles = int(cfg.shuttle_type_of.size());
+
+    // Charge curve, tabulated once per battery type
+    YAML::Node battery = config["battery"];
+    if (battery && battery["charge_curve"]) {
+        for (const auto& point : battery["charge_curve"])
+            cfg.charge_curve.push_back({point[0].as<double>(), point[1].as<double>()});
+    }
+    cfg.max_charge = std::max(cfg.max_recharge, 2 * cfg.trip_duration);
+    if (battery && battery["max_charge_minutes"])
+        cfg.max_charge = std::max(2 * cfg.trip_duration, battery["max_charge_minutes"].as<int>() / cfg.time_res);
+    build_charge_tables(cfg);
+
+    cfg.max_tasks = int(std::round(double(cfg.horizon) / cfg.trip_duration));
+    cfg.max_wait = 30 / cfg.time_res - 1;
+
+    YAML::Node solver = config["solver"];
+    cfg.time_limit = solver["time_limit"].as<int>();
+    cfg.log_verbosity = solver["log_verbosity"].as<std::string>();
+    cfg.engine = solver["engine"] ? solver["engine"].as<std::string>() : "cp";
+    if (cfg.engine != "cp" && cfg.engine != "mip" && cfg.engine != "compare")
+        throw std::invalid_argument("Unknown solver engine: " + cfg.engine);
+    cfg.model_type = solver["model"] ? solver["model"].as<std::string>() : "slots";
+    if (cfg.model_type != "slots" && cfg.model_type != "sequence")
+        throw std::invalid_argument("Unknown CP model: " + cfg.model_type);
+    // Variable charge gains need the SOC at each charge's start, which only the slot model tracks
+    if (!cfg.charge_curve.empty() && (cfg.engine != "cp" || cfg.model_type != "slots"))
+        throw std::invalid_argument("battery.charge_curve requires solver.engine 'cp' and solver.model 'slots'");
+    cfg.search_type = solver["search_type"].as<std::string>();
+    cfg.workers = solver["workers"] ? solver["workers"].as<int>() : 0;
+    cfg.parallel_mode = solver["parallel_mode"] ? solver["parallel_mode"].as<std::string>() : "Deterministic";
+    cfg.fail_limit = solver["fail_limit"] ? solver["fail_limit"].as<long>() : 0;
+    cfg.branch_limit = solver["branch_limit"] ? solver["branch_limit"].as<long>() : 0;
+    cfg.relative_gap = solver["relative_gap"] ? solver["relative_gap"].as<double>() : -1;
+    cfg.random_seed = solver["random_seed"] ? solver["random_seed"].as<int>() : 0;
+    cfg.aggregate_demand = solver["aggregate_demand"] && solver["aggregate_demand"].as<bool>();
+    cfg.warm_start = !solver["warm_start"] || solver["warm_start"].as<bool>();
+    cfg.presolve = !solver["presolve"] || solver["presolve"].as<bool>();
+    cfg.export_model = solver["export_model"] ? solver["export_model"].as<std::string>() : "";
+    cfg.heuristic_only = solver["heuristic_only"] && solver["heuristic_only"].as<bool>();
+
+    YAML::Node data = config["data"];
+    cfg.demand_cache = data && data["cache"] && data["cache"].as<bool>();
+
+    YAML::Node lns = config["lns"];
+    cfg.lns = lns && lns["enabled"] && lns["enabled"].as<bool>();
+    cfg.lns_iterations = lns && lns["iterations"] ? lns["iterations"].as<int>() : 500;
+    cfg.lns_iteration_time_limit = lns && lns["iteration_time_limit"] ? lns["iteration_time_limit"].as<int>() : 5;
+    cfg.lns_window = lns && lns["window_minutes"] ? lns["window_minutes"].as<int>() / cfg.time_res : cfg.horizon / 4;
+
+    YAML::Node rolling = config["rolling_horizon"];
+    cfg.rolling_horizon = rolling && rolling["enabled"] && rolling["enabled"].as<bool>();
+    if (cfg.rolling_horizon) {
+        cfg.window_length = rolling["window_minutes"].as<int>() / cfg.time_res;
+        cfg.window_overlap = rolling["overlap_minutes"].as<int>() / cfg.time_res;
+        cfg.window_time_limit = rolling["window_time_limit"] ? rolling["window_time_limit"].as<int>() : cfg.time_limit;
+        if (cfg.window_length <= cfg.window_overlap || cfg.window_length < 2 * cfg.trip_duration)
+            throw std::invalid_argument("rolling_horizon: window must exceed the overlap and fit a round trip");
+    } else {
+        cfg.window_length = cfg.horizon;
+        cfg.window_overlap = 0;
+        cfg.window_time_limit = cfg.time_limit;
+    }
+
+    YAML::Node portfolio = config["portfolio"];
+    cfg.portfolio = portfolio && portfolio["enabled"] && portfolio["enabled"].as<bool>();
+    cfg.portfolio_rounds = portfolio && portfolio["rounds"] ? portfolio["rounds"].as<int>() : 4;
+    if (portfolio && portfolio["members"]) {
+        for (const auto& member : portfolio["members"])
+            cfg.portfolio_members.push_back({member["search_type"].as<std::string>(),
+                                             member["workers"] ? member["workers"].as<int>() : 1,
+                                             member["random_seed"] ? member["random_seed"].as<int>() : cfg.random_seed});
+    } else {
+        for (const char* search_type : {"Restart", "MultiPoint", "DepthFirst"})
+            cfg.portfolio_members.push_back({search_type, 1, cfg.random_seed});
+    }
+    if (cfg.portfolio_rounds < 1)
+        throw std::invalid_argument("portfolio: rounds must be at least 1");
+
+    YAML::Node daemon = config["daemon"];
+    cfg.replan_time_limit = daemon && daemon["replan_time_limit"] ? daemon["replan_time_limit"].as<int>() : 10;
+
+    return cfg;
+}
+
+ProblemConfig with_horizon(const ProblemConfig& cfg, int start_time, int end_time) {
+    ProblemConfig window = cfg;
+    window.start_time = start_time;
+    window.end_time = end_time;
+    window.horizon = end_time - start_time;
+    window.max_tasks = int(std::round(double(window.horizon) / cfg.trip_duration));
+    return window;
+}
+
+ProblemConfig with_shuttles(const ProblemConfig& cfg, const std::vector<int>& shuttles) {
+    ProblemConfig fleet = cfg;
+    fleet.shuttle_type_of.clear();
+    for (auto& type : fleet.shuttle_types)
+        type.count = 0;
+    for (int q : shuttles) {
+        fleet.shuttle_type_of.push_back(cfg.shuttle_type_of[q]);
+        ++fleet.shuttle_types[cfg.shuttle_type_of[q]].count;
+    }
+    fleet.num_shuttles = int(shuttles.size());
+    return fleet;
+}
+
+ProblemConfig with_fleet_size(const ProblemConfig& cfg, int n) {
+    ProblemConfig fleet = cfg;
+    fleet.shuttle_types = {{"default", n, cfg.seat_capacity, cfg.battery_capacity, cfg.soc_threshold}};
+    fleet.shuttle_type_of.assign(n, 0);
+    fleet.num_shuttles = n;
+    build_charge_tables(fleet);
+    return fleet;
+}
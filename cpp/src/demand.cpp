@@ -0,0 +1,324 @@
+#include "demand.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+
+Direction parse_direction(const std::string& name) {
+    if (name == "OUTBOUND")
+        return Direction::Outbound;
+    if (name == "RETURN")
+        return Direction::Return;
+    throw std::invalid_argument("Unknown direction: " + name);
+}
+
+const char* direction_name(Direction direction) {
+    return direction == Direction::Outbound ? "OUTBOUND" : "RETURN";
+}
+
+namespace {
+
+// Passenger counts in the compact format are per 30-minute slot
+constexpr int COMPACT_SLOT_MINUTES = 30;
+
+// Read-only memory map of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        // The destructor does not run if the constructor throws, so the descriptor is closed here
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ < 0)
+            throw std::runtime_error("Cannot open demand file " + path);
+        if (fstat(fd_, &stat_) != 0) {
+            close(fd_);
+            throw std::runtime_error("Cannot open demand file " + path);
+        }
+        if (stat_.st_size > 0) {
+            void* data = mmap(nullptr, size_t(stat_.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (data == MAP_FAILED) {
+                close(fd_);
+                throw std::runtime_error("Cannot map demand file " + path);
+            }
+            data_ = static_cast<const char*>(data);
+        }
+    }
+    ~MappedFile() {
+        if (data_)
+            munmap(const_cast<char*>(data_), size_t(stat_.st_size));
+        if (fd_ >= 0)
+            close(fd_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + stat_.st_size; }
+    const struct stat& stat() const { return stat_; }
+
+private:
+    int fd_ = -1;
+    struct stat stat_ = {};
+    const char* data_ = nullptr;
+};
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+        s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+        s.remove_suffix(1);
+    return s;
+}
+
+// Splits one CSV line into fields; returns the number of fields
+size_t split_fields(std::string_view line, std::string_view* fields, size_t max_fields) {
+    size_t n = 0;
+    while (true) {
+        size_t comma = line.find(',');
+        if (n < max_fields)
+            fields[n] = trim(line.substr(0, comma));
+        ++n;
+        if (comma == std::string_view::npos)
+            return n;
+        line.remove_prefix(comma + 1);
+    }
+}
+
+// Line-numbered parse errors: "<file>:<line>: <message>"
+struct RowError {
+    const std::string& path;
+    size_t line;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error(path + ":" + std::to_string(line) + ": " + message);
+    }
+
+    long integer(std::string_view field, const char* column) const {
+        long value = 0;
+        auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (ec != std::errc() || end != field.data() + field.size() || field.empty())
+            fail(std::string("invalid ") + column + " '" + std::string(field) + "'");
+        return value;
+    }
+
+    // Non-negative number in any form strtod reads, e.g. 3, 3.5, .5, 1e2 or +3
+    // (from_chars for doubles is not available on every standard library we
+    // build with, and rejects a leading '+')
+    double number(std::string_view field, const char* column) const {
+        std::string text(field);
+        char* end = nullptr;
+        double value = text.empty() ? 0 : std::strtod(text.c_str(), &end);
+        if (text.empty() || end != text.c_str() + text.size() || !std::isfinite(value))
+            fail(std::string("invalid ") + column + " '" + text + "'");
+        if (value < 0)
+            fail(std::string("negative ") + column + " '" + text + "'");
+        return value;
+    }
+
+    Direction direction(std::string_view field) const {
+        if (field == "OUTBOUND" || field == "O" || field == "outbound" || field == "o")
+            return Direction::Outbound;
+        if (field == "RETURN" || field == "R" || field == "return" || field == "r")
+            return Direction::Return;
+        fail("invalid direction '" + std::string(field) + "'");
+    }
+};
+
+enum class DemandFormat { Requests, Slots };
+
+// Parses a mapped CSV in either format. Column order follows the header.
+std::vector<DemandRequest> parse_demand(const MappedFile& file, const std::string& path, int time_res,
+                                        bool requests_only) {
+    constexpr size_t MAX_FIELDS = 8;
+    std::string_view text(file.begin(), size_t(file.end() - file.begin()));
+    std::string_view fields[MAX_FIELDS];
+
+    // Header: find the required columns
+    size_t eol = text.find('\n');
+    std::string_view header = text.substr(0, eol);
+    text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+    size_t num_columns = std::min(split_fields(header, fields, MAX_FIELDS), MAX_FIELDS);
+    auto column = [&](std::string_view name) {
+        for (size_t c = 0; c < num_columns; ++c)
+            if (fields[c] == name)
+                return int(c);
+        return -1;
+    };
+
+    DemandFormat format;
+    int id_col = column("req_id"), time_col = column("time");
+    int slot_col = column("slot"), pax_col = column("passengers");
+    int dir_col = column("direction");
+    if (id_col >= 0 && time_col >= 0 && dir_col >= 0)
+        format = DemandFormat::Requests;
+    else if (!requests_only && slot_col >= 0 && pax_col >= 0 && dir_col >= 0)
+        format = DemandFormat::Slots;
+    else
+        throw std::runtime_error(path + ":1: expected header req_id,direction,time" +
+                                 std::string(requests_only ? "" : " or slot,direction,passengers"));
+
+    std::vector<DemandRequest> demands;
+    size_t line = 1;
+    while (!text.empty()) {
+        ++line;
+        eol = text.find('\n');
+        std::string_view row = text.substr(0, eol);
+        text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+        if (trim(row).empty())
+            continue;
+
+        RowError err{path, line};
+        size_t n = split_fields(row, fields, MAX_FIELDS);
+        if (n != num_columns)
+            err.fail("expected " + std::to_string(num_columns) + " fields, found " + std::to_string(n));
+
+        Direction direction = err.direction(fields[dir_col]);
+        if (format == DemandFormat::Requests) {
+            demands.push_back({int(err.integer(fields[id_col], "req_id")), direction,
+                               err.number(fields[time_col], "time")});
+        } else {
+            long slot = err.integer(fields[slot_col], "slot");
+            long passengers = err.integer(fields[pax_col], "passengers");
+            if (slot < 0 || passengers < 0)
+                err.fail("slot and passengers must be non-negative");
+            double time = double(slot) * COMPACT_SLOT_MINUTES / time_res;
+            for (long p = 0; p < passengers; ++p)
+                demands.push_back({int(demands.size()), direction, time});
+        }
+    }
+
+    // Expanded passengers are numbered in file order, then sorted by time
+    if (format == DemandFormat::Slots)
+        std::stable_sort(demands.begin(), demands.end(),
+                         [](const DemandRequest& a, const DemandRequest& b) { return a.time < b.time; });
+    return demands;
+}
+
+// Binary cache: header, then one fixed-size record per request
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    int64_t source_size;
+    int64_t source_mtime_ns;   // nanoseconds: same-second edits of the same size still differ
+    int32_t time_res;
+    uint32_t padding;
+    uint64_t count;
+};
+
+struct CacheRecord {
+    int32_t req_id;
+    int32_t direction;
+    double time;
+};
+static_assert(sizeof(CacheRecord) == 16, "unexpected padding in CacheRecord");
+
+constexpr char CACHE_MAGIC[4] = {'M', 'B', 'D', 'C'};
+constexpr uint32_t CACHE_VERSION = 2;
+
+CacheHeader cache_header(const struct stat& source, int time_res, size_t count) {
+    CacheHeader header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.source_size = int64_t(source.st_size);
+    header.source_mtime_ns = int64_t(source.st_mtim.tv_sec) * 1000000000 + int64_t(source.st_mtim.tv_nsec);
+    header.time_res = time_res;
+    header.count = count;
+    return header;
+}
+
+// Returns false if the cache is missing or stale
+bool read_cache(const std::string& cache_path, const struct stat& source, int time_res,
+                std::vector<DemandRequest>& demands) {
+    std::ifstream file(cache_path, std::ios::binary);
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+    CacheHeader expected = cache_header(source, time_res, header.count);
+    if (std::memcmp(&header, &expected, sizeof(header)) != 0)
+        return false;
+
+    std::vector<CacheRecord> records(header.count);
+    if (!file.read(reinterpret_cast<char*>(records.data()), std::streamsize(records.size() * sizeof(CacheRecord))))
+        return false;
+    demands.clear();
+    demands.reserve(records.size());
+    for (const auto& r : records)
+        demands.push_back({r.req_id, r.direction ? Direction::Return : Direction::Outbound, r.time});
+    return true;
+}
+
+void write_cache(const std::string& cache_path, const struct stat& source, int time_res,
+                 const std::vector<DemandRequest>& demands) {
+    std::vector<CacheRecord> records;
+    records.reserve(demands.size());
+    for (const auto& req : demands)
+        records.push_back({req.req_id, req.direction == Direction::Return, req.time});
+
+    // Write to a temporary file and rename so readers never see a partial cache
+    std::string tmp_path = cache_path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        CacheHeader header = cache_header(source, time_res, demands.size());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), std::streamsize(records.size() * sizeof(CacheRecord)));
+        if (!file)
+            return;   // the cache is an optimisation; a read-only directory is not an error
+    }
+    std::rename(tmp_path.c_str(), cache_path.c_str());
+}
+
+} // namespace
+
+std::vector<DemandRequest> load_demand_csv(const std::string& filename) {
+    MappedFile file(filename);
+    return parse_demand(file, filename, COMPACT_SLOT_MINUTES, true);
+}
+
+std::vector<DemandRequest> load_demand(const std::string& path, int time_res, bool use_cache) {
+    MappedFile file(path);
+    std::string cache_path = path + ".cache";
+    std::vector<DemandRequest> demands;
+    if (use_cache && read_cache(cache_path, file.stat(), time_res, demands))
+        return demands;
+
+    demands = parse_demand(file, path, time_res, false);
+    if (use_cache)
+        write_cache(cache_path, file.stat(), time_res, demands);
+    return demands;
+}
+
+void write_demand_csv(const std::string& filename, const std::vector<DemandRequest>& demands) {
+    std::ofstream file(filename);
+    if (!file)
+        throw std::runtime_error("Cannot write " + filename);
+    file << "req_id,direction,time" << std::endl;
+    for (const auto& req : demands)
+        file << req.req_id << "," << direction_name(req.direction) << "," << req.time << "\n";
+}
+
+std::vector<DemandGroup> group_demands(const std::vector<DemandRequest>& demands) {
+    std::vector<DemandGroup> groups;
+    std::map<std::pair<Direction, int>, size_t> index;
+
+    for (size_t d = 0; d < demands.size(); ++d) {
+        auto key = std::make_pair(demands[d].direction, static_cast<int>(demands[d].time));
+        auto it = index.find(key);
+        if (it == index.end()) {
+            it = index.emplace(key, groups.size()).first;
+            groups.push_back({key.first, key.second, {}});
+        }
+        groups[it->second].members.push_back(d);
+    }
+    return groups;
+}
@@ -0,0 +1,193 @@
+#include "heuristic.hpp"
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+constexpr int NONE = INT_MAX;
+
+struct Dispatcher {
+    const ProblemConfig& cfg;
+    const std::vector<DemandRequest>& demands;
+    Schedule schedule;
+    std::vector<size_t> pending[2];   // requests per direction, by requested time
+
+    Dispatcher(const ProblemConfig& c, const std::vector<DemandRequest>& d) : cfg(c), demands(d) {
+        schedule.shuttles.resize(cfg.num_shuttles);
+        schedule.served_by.assign(demands.size(), {-1, -1});
+        for (size_t k = 0; k < demands.size(); ++k)
+            pending[int(demands[k].direction)].push_back(k);
+        for (auto& list : pending)
+            std::stable_sort(list.begin(), list.end(), [&](size_t a, size_t b) {
+                return demands[a].time < demands[b].time;
+            });
+    }
+
+    // Earliest requested slot of an unserved request still catchable from time t
+    int next_request(Direction direction, int t) const {
+        for (size_t k : pending[int(direction)]) {
+            int td = static_cast<int>(demands[k].time);
+            if (schedule.served_by[k].first < 0 && td + cfg.max_wait >= t)
+                return td;
+        }
+        return NONE;
+    }
+
+    void push(int q, ShuttleState& state, TaskMode mode, int start, int length) {
+        auto& tasks = schedule.shuttles[q];
+        tasks.push_back({mode, int(tasks.size()), start, start + length});
+        state.available_from = start + length;
+        state.soc += charge_gain(mode, state.soc, length, cfg, q);
+        state.has_prev = true;
+        state.prev_mode = mode;
+    }
+
+    void board(int q, Direction direction) {
+        const auto& tasks = schedule.shuttles[q];
+        int position = int(tasks.size()) - 1;
+        int start = tasks.back().start;
+        int seats = shuttle_type(cfg, q).seat_capacity;
+        for (size_t k : pending[int(direction)]) {
+            if (seats == 0)
+                break;
+            int td = static_cast<int>(demands[k].time);
+            if (td > start)
+                break;
+            if (schedule.served_by[k].first < 0 && start <= td + cfg.max_wait) {
+                schedule.served_by[k] = {q, position};
+                --seats;
+            }
+        }
+    }
+};
+
+} // namespace
+
+Schedule greedy_schedule(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                         const std::vector<ShuttleState>& states) {
+    std::vector<ShuttleState> shuttle_states = states.empty() ? initial_states(cfg) : states;
+    for (auto& state : shuttle_states)
+        state.available_from = std::max(state.available_from, cfg.start_time);
+
+    Dispatcher dispatch(cfg, demands);
+    std::vector<bool> done(cfg.num_shuttles, false);
+
+    const int trip = cfg.trip_duration;
+    const int round_trip_soc = 2 * cfg.trip_distance;
+    const int latest_out = cfg.end_time - 2 * trip;
+
+    // Stops dispatching shuttle q. END may not follow a charge (a charge must be
+    // followed by a round trip), so trailing charges are dropped.
+    auto finish = [&](int q) {
+        auto& tasks = dispatch.schedule.shuttles[q];
+        while (!tasks.empty() && !can_follow(tasks.back().mode, TaskMode::END))
+            tasks.pop_back();
+        if (!tasks.empty())
+            shuttle_states[q].available_from = tasks.back().end;
+        done[q] = true;
+    };
+
+    while (true) {
+        // Shuttle that frees up first
+        int q = -1;
+        for (int k = 0; k < cfg.num_shuttles; ++k)
+            if (!done[k] && (q < 0 || shuttle_states[k].available_from < shuttle_states[q].available_from))
+                q = k;
+        if (q < 0)
+            break;
+
+        ShuttleState& state = shuttle_states[q];
+        const ShuttleType& type = shuttle_type(cfg, q);
+        int t = state.available_from;
+        // The last slot is reserved for END
+        int slots_left = cfg.max_tasks - 1 - int(dispatch.schedule.shuttles[q].size());
+
+        // Away from the hub: wait for the next return window if it opens within a
+        // round trip, otherwise come back empty
+        if (state.has_prev && state.prev_mode == TaskMode::OUT) {
+            int td = dispatch.next_request(Direction::Return, t);
+            int start = (td != NONE && td <= t + 2 * trip && td <= cfg.end_time - trip) ? std::max(t, td) : t;
+            dispatch.push(q, state, TaskMode::RET, start, trip);
+            dispatch.board(q, Direction::Return);
+            continue;
+        }
+
+        // At the hub: next outbound request, or the departure that meets the next return request
+        int next_out = dispatch.next_request(Direction::Outbound, t);
+        int next_ret = dispatch.next_request(Direction::Return, t + trip);
+        int want = std::min(next_out, next_ret == NONE ? NONE : next_ret - trip);
+        bool have_work = want != NONE && std::max(t, want) <= latest_out;
+        int idle = have_work ? std::max(t, want) - t : NONE;
+
+        bool must_out = !state.has_prev || state.prev_mode == TaskMode::CRGp;
+        bool low = state.soc < round_trip_soc;
+        if (must_out && low) {
+            // An OUT needs the energy for its RET
+            finish(q);
+            continue;
+        }
+        if (!must_out) {
+            // A charge must be followed by a round trip, within both the horizon and the slots.
+            // CRGp can only be followed by OUT, so it must restore a round trip's worth.
+            int crgp_gain = charge_gain(TaskMode::CRGp, state.soc, 2 * trip, cfg, q);
+            bool crgp_ok = state.prev_mode == TaskMode::RET
+                && state.soc <= type.soc_threshold
+                && crgp_gain > 0 && state.soc + crgp_gain <= type.battery_capacity
+                && state.soc + crgp_gain >= round_trip_soc
+                && t + 2 * trip <= latest_out && slots_left >= 3;
+            // CRGf can only be followed by OUT or CRGf: the chain of CRGf needed to
+            // afford a round trip must fit as a whole
+            int crgf_chain = 0;
+            int crgf_soc = state.soc;
+            do {
+                int gain = charge_gain(TaskMode::CRGf, crgf_soc, trip, cfg, q);
+                if (gain <= 0) {
+                    crgf_chain = NONE;
+                    break;
+                }
+                crgf_soc += gain;
+                ++crgf_chain;
+            } while (crgf_soc < round_trip_soc);
+            bool crgf_ok = crgf_chain != NONE
+                && crgf_soc <= type.battery_capacity
+                && t + crgf_chain * trip <= latest_out && slots_left >= crgf_chain + 2;
+
+            if (low || (have_work && idle >= trip)) {
+                if (crgp_ok && (low || idle >= 2 * trip)) {
+                    dispatch.push(q, state, TaskMode::CRGp, t, 2 * trip);
+                    continue;
+                }
+                if (crgf_ok) {
+                    dispatch.push(q, state, TaskMode::CRGf, t, trip);
+                    continue;
+                }
+                if (low) {
+                    // Cannot recharge enough to leave again
+                    finish(q);
+                    continue;
+                }
+            }
+
+            // Nothing left to serve: stay at the hub, unless a CRGf still requires an OUT
+            if (!have_work && state.prev_mode != TaskMode::CRGf) {
+                finish(q);
+                continue;
+            }
+        }
+
+        if (slots_left < 2 || t > latest_out) {
+            finish(q);
+            continue;
+        }
+        int start = have_work ? std::max(t, want) : t;
+        dispatch.push(q, state, TaskMode::OUT, start, trip);
+        dispatch.board(q, Direction::Outbound);
+    }
+
+    // Fill the remaining slots with END, as the model does
+    Schedule& schedule = dispatch.schedule;
+    for (int q = 0; q < cfg.num_shuttles; ++q)
+        pad_with_end(schedule.shuttles[q], shuttle_states[q].available_from, cfg);
+    return schedule;
+}
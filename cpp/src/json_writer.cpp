@@ -0,0 +1,143 @@
+#include "json_writer.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+JsonWriter::JsonWriter(std::ostream& out, int indent) : out_(out), indent_(indent) {}
+
+void JsonWriter::newline() {
+    if (indent_ == 0 || (!compact_stack_.empty() && compact_stack_.back()))
+        return;
+    out_ << '\n' << std::string(stack_.size() * size_t(indent_), ' ');
+}
+
+void JsonWriter::before_value() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (!stack_.empty()) {
+        if (stack_.back().count++ > 0)
+            out_ << (compact_stack_.back() ? ", " : ",");
+        newline();
+    }
+}
+
+JsonWriter& JsonWriter::begin_object() {
+    before_value();
+    out_ << '{';
+    stack_.push_back({true, 0});
+    compact_stack_.push_back(compact_ || (!compact_stack_.empty() && compact_stack_.back()));
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    bool empty = stack_.back().count == 0;
+    stack_.pop_back();
+    if (!empty)
+        newline();
+    compact_stack_.pop_back();
+    out_ << '}';
+    if (stack_.empty())
+        out_ << '\n';
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array() {
+    before_value();
+    out_ << '[';
+    stack_.push_back({false, 0});
+    compact_stack_.push_back(compact_ || (!compact_stack_.empty() && compact_stack_.back()));
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    bool empty = stack_.back().count == 0;
+    stack_.pop_back();
+    if (!empty)
+        newline();
+    compact_stack_.pop_back();
+    out_ << ']';
+    if (stack_.empty())
+        out_ << '\n';
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& name) {
+    before_value();
+    write_string(name);
+    out_ << ": ";
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int v) { return value(static_cast<long long>(v)); }
+JsonWriter& JsonWriter::value(long v) { return value(static_cast<long long>(v)); }
+
+JsonWriter& JsonWriter::value(long long v) {
+    before_value();
+    out_ << v;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long v) {
+    before_value();
+    out_ << v;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double v) {
+    if (!std::isfinite(v))
+        return null();
+    before_value();
+    // 15 significant digits when they read back as v, all 17 otherwise
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.15g", v);
+    if (std::strtod(buf, nullptr) != v)
+        std::snprintf(buf, sizeof(buf), "%.17g", v);
+    out_ << buf;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool v) {
+    before_value();
+    out_ << (v ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* v) { return value(std::string(v)); }
+
+JsonWriter& JsonWriter::value(const std::string& v) {
+    before_value();
+    write_string(v);
+    return *this;
+}
+
+void JsonWriter::write_string(const std::string& v) {
+    out_ << '"';
+    for (char c : v) {
+        switch (c) {
+            case '"':  out_ << "\\\""; break;
+            case '\\': out_ << "\\\\"; break;
+            case '\n': out_ << "\\n"; break;
+            case '\r': out_ << "\\r"; break;
+            case '\t': out_ << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out_ << buf;
+                } else {
+                    out_ << c;
+                }
+        }
+    }
+    out_ << '"';
+}
+
+JsonWriter& JsonWriter::null() {
+    before_value();
+    out_ << "null";
+    return *this;
+}
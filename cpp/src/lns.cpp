@@ -0,0 +1,132 @@
+#include "lns.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace {
+
+enum Neighborhood { ONE_SHUTTLE, TWO_SHUTTLES, TIME_WINDOW, NUM_NEIGHBORHOODS };
+
+const char* neighborhood_name(int n) {
+    switch (n) {
+        case ONE_SHUTTLE:  return "one shuttle";
+        case TWO_SHUTTLES: return "two shuttles";
+        default:           return "time window";
+    }
+}
+
+// Start of the first task present in grid slot (q, j) of the solution, or -1 if the slot is unused
+IloInt slot_start(const IloSolution& sol, const TaskGrid& tasks, int q, int j) {
+    for (TaskMode mode : ALL_TASK_MODES)
+        if (tasks.has(q, j, mode) && sol.isPresent(tasks(q, j, mode)))
+            return sol.getStart(tasks(q, j, mode));
+    return -1;
+}
+
+} // namespace
+
+bool run_lns(IloCP& cp, ShuttleModel& sm, const ProblemConfig& cfg, IloSolution& incumbent, double& objective,
+             std::ostream& log) {
+    IloEnv env = cp.getEnv();
+    const TaskGrid& tasks = sm.tasks;
+    auto t0 = std::chrono::steady_clock::now();
+    auto elapsed = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    };
+
+    // Initial incumbent: the first solution, however long it takes within the budget
+    cp.setParameter(IloCP::TimeLimit, cfg.time_limit);
+    cp.setParameter(IloCP::SolutionLimit, 1);
+    bool found = cp.solve();
+    cp.setParameter(IloCP::SolutionLimit, IloIntMax);
+    if (!found)
+        return false;
+    incumbent = IloSolution(env);
+    incumbent.add(sm.all_intervals);
+    incumbent.add(sm.assign_vars);
+    incumbent.store(cp);
+    objective = cp.getObjValue();
+    log << "LNS initial objective: " << objective << std::endl;
+
+    cp.setParameter(IloCP::LogVerbosity, IloCP::Quiet);
+    std::mt19937 rng(cfg.random_seed);
+    double weights[NUM_NEIGHBORHOODS] = {1.0, 1.0, 1.0};
+    int improvements[NUM_NEIGHBORHOODS] = {0, 0, 0};
+    const double reaction = 0.2;
+
+    for (int it = 0; it < cfg.lns_iterations && elapsed() < cfg.time_limit; ++it) {
+        // Never run past the overall time limit
+        cp.setParameter(IloCP::TimeLimit, std::min(double(cfg.lns_iteration_time_limit), cfg.time_limit - elapsed()));
+        int n = std::discrete_distribution<int>(weights, weights + NUM_NEIGHBORHOODS)(rng);
+
+        // Slots left free by the neighborhood
+        std::vector<bool> free_slot(size_t(tasks.num_shuttles()) * tasks.max_tasks(), false);
+        if (n == TIME_WINDOW) {
+            int span = std::max(1, cfg.horizon - cfg.lns_window);
+            int lo = cfg.start_time + std::uniform_int_distribution<int>(0, span - 1)(rng);
+            int hi = lo + cfg.lns_window;
+            for (int q = 0; q < tasks.num_shuttles(); ++q)
+                for (int j = 0; j < tasks.max_tasks(); ++j) {
+                    IloInt start = slot_start(incumbent, tasks, q, j);
+                    free_slot[size_t(q) * tasks.max_tasks() + j] = start < 0 || (start >= lo && start < hi);
+                }
+        } else {
+            std::vector<int> order(tasks.num_shuttles());
+            for (int q = 0; q < tasks.num_shuttles(); ++q)
+                order[q] = q;
+            std::shuffle(order.begin(), order.end(), rng);
+            int count = std::min(n == ONE_SHUTTLE ? 1 : 2, tasks.num_shuttles());
+            for (int k = 0; k < count; ++k)
+                for (int j = 0; j < tasks.max_tasks(); ++j)
+                    free_slot[size_t(order[k]) * tasks.max_tasks() + j] = true;
+        }
+
+        // Fix every other slot, and the passengers boarded on it, to the incumbent
+        IloConstraintArray fix(env);
+        for (int q = 0; q < tasks.num_shuttles(); ++q) {
+            for (int j = 0; j < tasks.max_tasks(); ++j) {
+                if (free_slot[size_t(q) * tasks.max_tasks() + j])
+                    continue;
+                for (TaskMode mode : ALL_TASK_MODES) {
+                    if (!tasks.has(q, j, mode))
+                        continue;
+                    const IloIntervalVar& var = tasks(q, j, mode);
+                    if (incumbent.isPresent(var)) {
+                        fix.add(IloPresenceOf(env, var) == 1);
+                        fix.add(IloStartOf(var) == incumbent.getStart(var));
+                    } else {
+                        fix.add(IloPresenceOf(env, var) == 0);
+                    }
+                }
+            }
+        }
+        for (size_t k = 0; k < sm.assign_index.arcs.size(); ++k) {
+            const auto& arc = sm.assign_index.arcs[k];
+            if (!free_slot[size_t(arc.shuttle) * tasks.max_tasks() + arc.task])
+                fix.add(sm.assign[k] == incumbent.getValue(sm.assign[k]));
+        }
+
+        sm.model.add(fix);
+        cp.setStartingPoint(incumbent);
+        bool improved = cp.solve() && cp.getObjValue() < objective - 1e-6;
+        if (improved) {
+            incumbent.store(cp);
+            objective = cp.getObjValue();
+            ++improvements[n];
+            log << "LNS iteration " << it << " (" << neighborhood_name(n) << "): objective "
+                << objective << " at " << elapsed() << " s" << std::endl;
+        }
+        sm.model.remove(fix);
+        fix.endElements();
+        fix.end();
+
+        weights[n] = std::max(0.05, (1 - reaction) * weights[n] + reaction * (improved ? 1.0 : 0.0));
+    }
+
+    log << "LNS finished after " << elapsed() << " s, objective " << objective << std::endl;
+    for (int n = 0; n < NUM_NEIGHBORHOODS; ++n)
+        log << "  " << neighborhood_name(n) << ": " << improvements[n]
+            << " improvements, weight " << weights[n] << std::endl;
+    return true;
+}
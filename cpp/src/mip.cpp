@@ -0,0 +1,214 @@
+#include "mip.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+
+#include "network.hpp"
+
+namespace {
+
+// Shuttles of one type, routed as one flow through their own network
+struct FleetClass {
+    std::vector<int> members;
+    TimeExpandedNetwork net;
+    IloIntVarArray x;
+};
+
+} // namespace
+
+MipResult solve_mip(IloEnv env, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                    std::ostream& log) {
+    auto t0 = std::chrono::steady_clock::now();
+    // Same weights as the CP objective
+    const double alpha = 100;
+    const double gamma = 1000000;
+    const double delta = 1;
+
+    std::vector<DemandGroup> groups = group_demands(demands);
+    IloModel model(env);
+
+    // One network and one flow per shuttle type: shuttles of a type are interchangeable
+    std::vector<FleetClass> classes;
+    for (size_t k = 0; k < cfg.shuttle_types.size(); ++k) {
+        FleetClass fleet_class;
+        for (int q = 0; q < cfg.num_shuttles; ++q)
+            if (cfg.shuttle_type_of[q] == int(k))
+                fleet_class.members.push_back(q);
+        if (fleet_class.members.empty())
+            continue;
+        fleet_class.net = build_network(cfg, fleet_class.members.front());
+        fleet_class.x = IloIntVarArray(env);
+        classes.push_back(std::move(fleet_class));
+    }
+
+    // Trips departing per (direction, slot), and the seats they offer
+    std::map<std::pair<Direction, int>, IloExpr> trips;
+    IloExpr trip_count(env);
+    IloIntVarArray flow_vars(env);
+    size_t num_arcs = 0, num_states = 0;
+    for (size_t c = 0; c < classes.size(); ++c) {
+        const TimeExpandedNetwork& net = classes[c].net;
+        IloIntVarArray& x = classes[c].x;
+        const IloInt size = IloInt(classes[c].members.size());
+        const IloInt seats = shuttle_type(cfg, classes[c].members.front()).seat_capacity;
+        num_arcs += net.arcs.size();
+        num_states += net.num_nodes();
+
+        // Shuttle flow on each arc
+        for (size_t a = 0; a < net.arcs.size(); ++a) {
+            const NetworkArc& arc = net.arcs[a];
+            std::string name = arc.wait ? "wait" : task_mode_name(arc.mode);
+            x.add(IloIntVar(env, 0, size, (name + "_" + std::to_string(c) + "_" + std::to_string(a)).c_str()));
+        }
+        flow_vars.add(x);
+
+        // Flow conservation; the class's shuttles leave the source and arrive at the hub at the end
+        for (size_t n = 0; n < net.num_nodes(); ++n) {
+            if (net.out_arcs[n].empty() && net.in_arcs[n].empty())
+                continue;
+            IloExpr balance(env);
+            for (int a : net.out_arcs[n])
+                balance += x[a];
+            for (int a : net.in_arcs[n])
+                balance -= x[a];
+            if (int(n) == net.source)
+                model.add(balance == size);
+            else if (!net.out_arcs[n].empty())
+                model.add(balance == 0);
+            balance.end();
+        }
+
+        for (size_t a = 0; a < net.arcs.size(); ++a) {
+            const NetworkArc& arc = net.arcs[a];
+            if (arc.wait || (arc.mode != TaskMode::OUT && arc.mode != TaskMode::RET))
+                continue;
+            Direction direction = arc.mode == TaskMode::OUT ? Direction::Outbound : Direction::Return;
+            auto key = std::make_pair(direction, arc.start);
+            if (!trips.count(key))
+                trips.emplace(key, IloExpr(env));
+            trips.at(key) += seats * x[a];
+            trip_count += x[a];
+        }
+    }
+
+    // Boarding per (group, departure slot) inside the group's window
+    IloExpr cost(env);
+    IloIntVarArray boarding_vars(env);
+    std::vector<std::vector<std::pair<int, IloIntVar>>> board(groups.size());
+    std::map<std::pair<Direction, int>, IloExpr> boarded;
+    IloIntVarArray unmet(env);
+    for (size_t g = 0; g < groups.size(); ++g) {
+        const DemandGroup& group = groups[g];
+        IloInt size = IloInt(group.members.size());
+        IloExpr served(env);
+        for (int t = std::max(group.slot, cfg.start_time); t <= group.slot + cfg.max_wait; ++t) {
+            auto key = std::make_pair(group.direction, t);
+            if (!trips.count(key))
+                continue;
+            IloIntVar y(env, 0, size, ("board_" + std::to_string(g) + "_" + std::to_string(t)).c_str());
+            board[g].push_back({t, y});
+            boarding_vars.add(y);
+            served += y;
+            cost += alpha * (t - group.slot) * y;
+            if (!boarded.count(key))
+                boarded.emplace(key, IloExpr(env));
+            boarded.at(key) += y;
+        }
+        IloIntVar u(env, 0, size, ("u_" + std::to_string(g)).c_str());
+        unmet.add(u);
+        model.add(served + u == size);
+        cost += gamma * u;
+        served.end();
+    }
+
+    // Seat capacity of the trips departing in each slot
+    for (auto& entry : boarded) {
+        model.add(entry.second <= trips.at(entry.first));
+        entry.second.end();
+    }
+    for (auto& entry : trips)
+        entry.second.end();
+
+    cost += delta * trip_count;
+    model.add(IloMinimize(env, cost));
+    cost.end();
+    trip_count.end();
+
+    IloCplex cplex(model);
+    cplex.setOut(log);
+    cplex.setWarning(log);
+    cplex.setParam(IloCplex::Param::TimeLimit, cfg.time_limit);
+    if (cfg.workers > 0)
+        cplex.setParam(IloCplex::Param::Threads, cfg.workers);
+    if (cfg.relative_gap >= 0)
+        cplex.setParam(IloCplex::Param::MIP::Tolerances::MIPGap, cfg.relative_gap);
+    cplex.setParam(IloCplex::Param::RandomSeed, cfg.random_seed);
+    log << "MIP: " << num_arcs << " arcs over " << num_states << " network states in " << classes.size()
+        << " shuttle type(s), " << boarding_vars.getSize() << " boarding variables." << std::endl;
+
+    MipResult result;
+
+    // LP relaxation first, as a quality certificate independent of the MIP search
+    IloConversion relax_x(env, flow_vars, ILOFLOAT);
+    IloConversion relax_board(env, boarding_vars, ILOFLOAT);
+    IloConversion relax_unmet(env, unmet, ILOFLOAT);
+    model.add(relax_x);
+    model.add(relax_board);
+    model.add(relax_unmet);
+    if (cplex.solve())
+        result.lp_bound = cplex.getObjValue();
+    model.remove(relax_x);
+    model.remove(relax_board);
+    model.remove(relax_unmet);
+    log << "MIP: LP relaxation bound " << result.lp_bound << std::endl;
+
+    if (cplex.solve()) {
+        result.found = true;
+        result.objective = cplex.getObjValue();
+        result.bound = cplex.getBestObjValue();
+
+        result.schedule.shuttles.resize(cfg.num_shuttles);
+        for (const FleetClass& fleet_class : classes) {
+            std::vector<int> flow(fleet_class.net.arcs.size());
+            for (size_t a = 0; a < flow.size(); ++a)
+                flow[a] = int(cplex.getValue(fleet_class.x[IloInt(a)]) + 0.5);
+            auto paths = decompose_flow(fleet_class.net, with_shuttles(cfg, fleet_class.members), flow);
+            for (size_t i = 0; i < paths.size(); ++i)
+                result.schedule.shuttles[fleet_class.members[i]] = std::move(paths[i]);
+        }
+
+        // Seat each group's boarded passengers, in input order, on the trips leaving that slot
+        std::map<std::pair<Direction, int>, std::vector<std::pair<int, int>>> seats;   // (shuttle, position), seats left
+        for (int q = 0; q < cfg.num_shuttles; ++q) {
+            const auto& tasks = result.schedule.shuttles[q];
+            for (size_t k = 0; k < tasks.size(); ++k)
+                if (tasks[k].mode == TaskMode::OUT || tasks[k].mode == TaskMode::RET)
+                    for (int s = 0; s < shuttle_type(cfg, q).seat_capacity; ++s)
+                        seats[{tasks[k].mode == TaskMode::OUT ? Direction::Outbound : Direction::Return, tasks[k].start}]
+                            .push_back({q, int(k)});
+        }
+        result.schedule.served_by.assign(demands.size(), {-1, -1});
+        for (size_t g = 0; g < groups.size(); ++g) {
+            size_t next = 0;
+            for (const auto& [t, y] : board[g]) {
+                int n = int(cplex.getValue(y) + 0.5);
+                auto& free_seats = seats[{groups[g].direction, t}];
+                for (; n > 0 && next < groups[g].members.size() && !free_seats.empty(); --n) {
+                    result.schedule.served_by[groups[g].members[next++]] = free_seats.back();
+                    free_seats.pop_back();
+                }
+            }
+        }
+    } else {
+        result.schedule.shuttles.resize(cfg.num_shuttles);
+        result.schedule.served_by.assign(demands.size(), {-1, -1});
+    }
+    log << "MIP status: " << (result.found ? "solved" : "no solution") << ", objective " << result.objective
+        << ", bound " << result.bound << std::endl;
+
+    cplex.end();
+    result.solve_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
@@ -0,0 +1,994 @@
+#include "model.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace {
+
+// Times the constraint families of build_model in turn and sizes each one by
+// the top-level extractables it added to the model. Inert without a profiler.
+class FamilyTimer {
+public:
+    FamilyTimer(Profiler* profiler, const IloModel& model) : profiler_(profiler), model_(model) {}
+    ~FamilyTimer() { finish(); }
+
+    // Closes the current family and opens the next one, which creates the given number of variables
+    void next(const std::string& family, long variables = 0) {
+        finish();
+        if (!profiler_)
+            return;
+        phase_.reset(new ScopedPhase(profiler_, family));
+        index_ = profiler_->phases().size() - 1;
+        before_ = count();
+        variables_ = variables;
+    }
+
+    void finish() {
+        if (!phase_)
+            return;
+        phase_->stop();
+        profiler_->set_size(index_, count() - before_, variables_);
+        phase_.reset();
+    }
+
+private:
+    long count() const {
+        long n = 0;
+        for (IloModel::Iterator it(model_); it.ok(); ++it)
+            ++n;
+        return n;
+    }
+
+    Profiler* profiler_;
+    IloModel model_;
+    std::unique_ptr<ScopedPhase> phase_;
+    size_t index_ = 0;
+    long before_ = 0;
+    long variables_ = 0;
+};
+
+// Objective weights: waiting time, unmet passengers, trips
+constexpr double alpha = 100;
+constexpr double gamma = 1000000;
+constexpr double delta = 1;
+
+// Demand items: single passengers, or (direction, slot) groups when aggregated
+void set_demand_items(ShuttleModel& sm, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands) {
+    sm.aggregated = cfg.aggregate_demand;
+    if (!sm.aggregated) {
+        for (const auto& req : demands) {
+            int td = static_cast<int>(req.time);
+            sm.windows.push_back({req.direction, td, td + cfg.max_wait});
+            sm.item_size.push_back(1);
+        }
+    } else {
+        // Requests with the same direction and requested slot are interchangeable,
+        // so only the number of passengers boarded from each group is decided.
+        sm.groups = group_demands(demands);
+        for (const auto& group : sm.groups) {
+            sm.windows.push_back({group.direction, group.slot, group.slot + cfg.max_wait});
+            sm.item_size.push_back(int(group.members.size()));
+        }
+    }
+}
+
+// Assignment of the demand items to the trips of sm.tasks, whose start bounds
+// per (shuttle, task) are given. Returns the unmet demand and waiting time
+// terms of the objective.
+IloExpr add_demand_model(IloEnv env, const ProblemConfig& cfg, const std::vector<TaskBounds>& bounds,
+                         ShuttleModel& sm, FamilyTimer& families) {
+    IloModel& model = sm.model;
+    const TaskGrid& tasks = sm.tasks;
+    IloExpr demand_cost(env);
+    sm.assign_vars = IloIntVarArray(env);
+
+    // Only (shuttle, task, item) pairs whose trip can start inside the item's window get a variable
+    families.next("assignment index");
+    sm.assign_index = build_assignment_index(bounds, tasks.max_tasks(), sm.windows);
+    const AssignmentIndex& assign_index = sm.assign_index;
+
+    // Per-passenger model: boolean "request d rides (q, i)"; grouped model: number of
+    // passengers of group g boarded on (q, i)
+    families.next("assignment variables", long(assign_index.arcs.size()));
+    sm.assign.resize(assign_index.arcs.size());
+    for (size_t k = 0; k < assign_index.arcs.size(); ++k) {
+        const auto& arc = assign_index.arcs[k];
+        std::string suffix = "shuttle" + std::to_string(arc.shuttle) + "_task" + std::to_string(arc.task);
+        if (!sm.aggregated)
+            sm.assign[k] = IloBoolVar(env, ("assign_" + suffix + "_to_request" + std::to_string(arc.item)).c_str());
+        else
+            sm.assign[k] = IloIntVar(env, 0, std::min(IloInt(shuttle_type(cfg, arc.shuttle).seat_capacity),
+                                                      IloInt(sm.item_size[arc.item])),
+                ("board_" + suffix + "_from_group" + std::to_string(arc.item)).c_str());
+        sm.assign_vars.add(sm.assign[k]);
+    }
+
+    // Boarding anyone requires the matching trip, inside the item's time window
+    families.next("boarding windows");
+    for (size_t k = 0; k < assign_index.arcs.size(); ++k) {
+        const auto& arc = assign_index.arcs[k];
+        const TripWindow& window = sm.windows[arc.item];
+        const IloIntervalVar& task = tasks(arc.shuttle, arc.task, trip_mode(window.direction));
+        IloIntVar a = sm.assign[k];
+
+        model.add(IloIfThen(env, a >= 1, IloPresenceOf(env, task) == 1));
+        model.add(IloIfThen(env, a >= 1, IloStartOf(task) >= window.earliest));
+        model.add(IloIfThen(env, a >= 1, IloStartOf(task) <= window.latest));
+    }
+
+    // Add constraints to ensure that each shuttle can only handle a maximum number of passengers
+    // per trip, which is equal to the seat capacity. A sequence-model task index holds one
+    // trip of each direction.
+    families.next("seat capacity");
+    for (int q = 0; q < tasks.num_shuttles(); ++q) {
+        for (int i = 0; i < tasks.max_tasks(); ++i) {
+            if (assign_index.task_arcs(q, i).empty())
+                continue;
+            for (Direction direction : {Direction::Outbound, Direction::Return}) {
+                IloExpr pax(env);
+                bool any = false;
+                for (int k : assign_index.task_arcs(q, i)) {
+                    if (sm.windows[assign_index.arcs[k].item].direction != direction)
+                        continue;
+                    pax += sm.assign[k];
+                    any = true;
+                }
+                if (any)
+                    model.add(pax <= shuttle_type(cfg, q).seat_capacity);
+                pax.end();
+            }
+        }
+    }
+
+    // Coverage: boarded + unmet passengers equals the item size,
+    // and the item's wait is the sum of boarded passengers times their delay
+    families.next("coverage and wait", 2 * long(sm.windows.size()));
+    for (size_t d = 0; d < sm.windows.size(); ++d) {
+        IloInt size = sm.item_size[d];
+        IloIntVar u(env, 0, size, ("u_" + std::to_string(d)).c_str());
+        IloIntVar w(env, 0, size * (cfg.end_time - cfg.start_time), ("w_" + std::to_string(d)).c_str());
+
+        IloExpr assign_sum(env);
+        IloExpr wait_sum(env);
+        for (int k : assign_index.by_item[d]) {
+            const auto& arc = assign_index.arcs[k];
+            const IloIntervalVar& task = tasks(arc.shuttle, arc.task, trip_mode(sm.windows[d].direction));
+            assign_sum += sm.assign[k];
+            wait_sum += sm.assign[k] * (IloStartOf(task) - sm.windows[d].earliest);
+        }
+        model.add(assign_sum + u == size);
+        model.add(w == wait_sum);
+        assign_sum.end();
+        wait_sum.end();
+
+        demand_cost += alpha * w;
+        demand_cost += gamma * u;
+    }
+    return demand_cost;
+}
+
+// True if shuttles a and b open the horizon in the same state
+bool same_state(const ShuttleState& a, const ShuttleState& b) {
+    return a.available_from == b.available_from && a.soc == b.soc && a.has_prev == b.has_prev &&
+           (!a.has_prev || a.prev_mode == b.prev_mode);
+}
+
+// Everything of the slot model above the demand layer
+ModelSkeleton build_slot_skeleton(IloEnv env, const ProblemConfig& cfg, const std::vector<ShuttleState>& shuttle_states,
+                                  Profiler* profiler) {
+    const IloInt start_time = cfg.start_time;
+    const IloInt end_time = cfg.end_time;
+    const IloInt num_shuttles = cfg.num_shuttles;
+    const IloInt max_tasks = cfg.max_tasks;
+    const IloInt trip_duration = cfg.trip_duration;
+    const IloInt trip_distance = cfg.trip_distance;
+
+    ModelSkeleton sk;
+    sk.model = IloModel(env);
+    sk.tasks = TaskGrid(num_shuttles, max_tasks);
+    IloModel& model = sk.model;
+    TaskGrid& tasks = sk.tasks;
+    FamilyTimer families(profiler, model);
+
+    // Create variables for each shuttle and task
+    families.next("interval variables", long(num_shuttles) * max_tasks * (NUM_TASK_MODES + 1));
+    for (int i = 0; i < num_shuttles; ++i) {
+        for (int j = 0; j < max_tasks; ++j) {
+
+            std::string base = "shuttle_" + std::to_string(i) + "_to_task_" + std::to_string(j) + "_";
+
+            // For each shuttle, create a master interval
+            IloIntervalVar& shuttle_master = tasks.master(i, j);
+            shuttle_master = IloIntervalVar(env);
+            shuttle_master.setOptional();
+            shuttle_master.setName((base + "S").c_str());
+
+            IloIntervalVarArray alts(env);
+            for (TaskMode mode : ALL_TASK_MODES) {
+                IloIntervalVar& var = tasks(i, j, mode);
+                switch (mode) {
+                    case TaskMode::CRGp:
+                    case TaskMode::CRGf:
+                        // Fixed length, or at least that long with a charge curve
+                        var = IloIntervalVar(env, mode == TaskMode::CRGp ? trip_duration * 2 : trip_duration);
+                        if (!cfg.charge_curve.empty())
+                            var.setSizeMax(cfg.max_charge);
+                        break;
+                    case TaskMode::END:
+                        // Idle until the end of the horizon: a shuttle's only END
+                        // covers its whole idle tail, and the slots after it are empty
+                        var = IloIntervalVar(env);
+                        var.setLengthMin(0);
+                        var.setEndMin(end_time);
+                        break;
+                    default:
+                        var = IloIntervalVar(env, trip_duration);
+                        break;
+                }
+                var.setOptional();
+                var.setStartMin(start_time);
+                var.setEndMax(end_time);
+                var.setName((base + task_mode_name(mode)).c_str());
+                alts.add(var);
+            }
+
+            // Constraint to force exactly one mode to be present for each slot
+            model.add(IloAlternative(env, shuttle_master, alts));
+        }
+
+        // Ensure the first task follows on from the shuttle's state (an OUT for a
+        // fresh shuttle); the last slot can only hold the END
+        const ShuttleState& state = shuttle_states[i];
+        tasks.master(i, 0).setPresent();
+        tasks.master(i, 0).setStartMin(state.available_from);
+        for (TaskMode mode : ALL_TASK_MODES)
+            if (!state.allows_first(mode))
+                tasks(i, 0, mode).setAbsent();
+        if (!state.has_prev)
+            tasks(i, 0, TaskMode::OUT).setPresent();
+        for (TaskMode mode : ALL_TASK_MODES)
+            if (mode != TaskMode::END)
+                tasks(i, max_tasks - 1, mode).setAbsent();
+    }
+
+    // Tighten trip start bounds from the task index; slots that can never host
+    // a direction drop the corresponding interval altogether
+    families.next("trip bounds");
+    std::vector<TaskBounds>& bounds = sk.bounds;
+    for (int i = 0; i < num_shuttles; ++i)
+        bounds.push_back(compute_task_bounds(shuttle_states[i], cfg.end_time, cfg.trip_duration, cfg.max_tasks));
+    for (int i = 0; i < num_shuttles; ++i) {
+        const TaskBounds& task_bounds = bounds[i];
+        for (int j = 0; j < max_tasks; ++j) {
+            IloIntervalVar& out = tasks(i, j, TaskMode::OUT);
+            IloIntervalVar& ret = tasks(i, j, TaskMode::RET);
+            if (task_bounds.out_earliest[j] > task_bounds.out_latest[j]) {
+                out.setAbsent();
+            } else {
+                out.setStartMin(task_bounds.out_earliest[j]);
+                out.setStartMax(task_bounds.out_latest[j]);
+            }
+            if (task_bounds.ret_earliest[j] > task_bounds.ret_latest[j]) {
+                ret.setAbsent();
+            } else {
+                ret.setStartMin(task_bounds.ret_earliest[j]);
+                ret.setStartMax(task_bounds.ret_latest[j]);
+            }
+        }
+    }
+
+    // Logic Transition constraints
+    families.next("transitions");
+    for (int i = 0; i < num_shuttles; ++i) {
+        for (int j = 0; j < max_tasks - 1; ++j) {
+
+            // Força: OUT só pode ser seguido de RET
+            model.add(IloIfThen(env,
+                IloPresenceOf(env, tasks(i, j, TaskMode::OUT)) == 1,
+                IloPresenceOf(env, tasks(i, j+1, TaskMode::RET)) == 1));
+
+            // RET pode ser seguido de OUT, CRGp, ou CRGf (pelo menos um presente)
+            IloExpr sum_after_ret(env);
+            for (TaskMode next : {TaskMode::OUT, TaskMode::CRGp, TaskMode::CRGf, TaskMode::END})
+                sum_after_ret += IloPresenceOf(env, tasks(i, j+1, next));
+            model.add(IloIfThen(env,
+                IloPresenceOf(env, tasks(i, j, TaskMode::RET)) == 1,
+                sum_after_ret == 1));
+            sum_after_ret.end();
+
+            // CRGf só pode ser seguido de OUT ou outro CRGf
+            IloExpr sum_after_crg(env);
+            for (TaskMode next : {TaskMode::OUT, TaskMode::CRGf})
+                sum_after_crg += IloPresenceOf(env, tasks(i, j+1, next));
+            model.add(IloIfThen(env,
+                IloPresenceOf(env, tasks(i, j, TaskMode::CRGf)) == 1,
+                sum_after_crg == 1));
+            sum_after_crg.end();
+
+            // CRGp só pode ser seguido de OUT
+            model.add(IloIfThen(env,
+                IloPresenceOf(env, tasks(i, j, TaskMode::CRGp)) == 1,
+                IloPresenceOf(env, tasks(i, j+1, TaskMode::OUT)) == 1));
+
+            // END fecha a lista: os slots seguintes ficam vazios
+            model.add(IloIfThen(env,
+                IloPresenceOf(env, tasks(i, j, TaskMode::END)) == 1,
+                IloPresenceOf(env, tasks.master(i, j+1)) == 0));
+        }
+    }
+
+    // Enforce chaining: if a task is present, the next task starts after the previous ends.
+    // Used slots form a prefix, so an empty slot is only ever followed by empty ones.
+    // Can be further reduced for scalability
+    families.next("chaining");
+    for (int i = 0; i < num_shuttles; ++i) {
+        for (int j = 0; j < max_tasks - 1; ++j) {
+            model.add(IloEndBeforeStart(env, tasks.master(i, j), tasks.master(i, j+1)));
+            model.add(IloPresenceOf(env, tasks.master(i, j+1)) <= IloPresenceOf(env, tasks.master(i, j)));
+        }
+    }
+
+    // The idle tail starts right after the last task, so END placement is not a free choice
+    families.next("idle tail");
+    for (int i = 0; i < num_shuttles; ++i) {
+        const IloIntervalVar& first_end = tasks(i, 0, TaskMode::END);
+        model.add(IloIfThen(env, IloPresenceOf(env, first_end) == 1,
+                            IloStartOf(first_end) == shuttle_states[i].available_from));
+        for (int j = 1; j < max_tasks; ++j)
+            model.add(IloIfThen(env, IloPresenceOf(env, tasks(i, j, TaskMode::END)) == 1,
+                                IloStartOf(tasks(i, j, TaskMode::END)) == IloEndOf(tasks.master(i, j-1))));
+    }
+
+    // Each shuttle's SOC starts at its initial state (the battery capacity for a fresh shuttle) and is reduced by the trip distance
+    // for each "OUT" and "RET" task, and increased by the recharge rate
+    // for each "CRG" task, while ensuring that the SOC remains non-negative.
+    // The SOC is initialized at the start time and must remain within the battery capacity.
+    families.next("state of charge");
+    for (int i = 0; i < num_shuttles; ++i) {
+        const IloInt battery_capacity = shuttle_type(cfg, i).battery_capacity;
+        const ChargeTable* charging = shuttle_type(cfg, i).charging.get();
+        IloCumulFunctionExpr shuttle_soc(env);
+
+        // Set initial SOC at the start of the horizon
+        shuttle_soc += IloStep(env, start_time, shuttle_states[i].soc);
+
+        for (int j = 0; j < max_tasks; ++j) {
+            shuttle_soc -= IloStepAtStart(tasks(i, j, TaskMode::OUT), trip_distance);
+            shuttle_soc -= IloStepAtStart(tasks(i, j, TaskMode::RET), trip_distance);
+            // Add the recharge rate for the length of CRG task:
+            //double recharge_rate_p = (double)battery_capacity / (double)max_recharge;
+            //double recharge_rate_f = (double)battery_capacity / (double)min_recharge;
+
+            //shuttle_soc += IloPulse(tasks(i, j, TaskMode::CRGp), recharge_rate_p);
+            //shuttle_soc += IloPulse(tasks(i, j, TaskMode::CRGf), recharge_rate_f);
+
+            if (charging) {
+                // Gain set below from the charge table
+                shuttle_soc += IloStepAtEnd(tasks(i, j, TaskMode::CRGp), 0, battery_capacity);
+                shuttle_soc += IloStepAtEnd(tasks(i, j, TaskMode::CRGf), 0, battery_capacity);
+            } else {
+                shuttle_soc += IloStepAtEnd(tasks(i, j, TaskMode::CRGp), battery_capacity / 2);
+                shuttle_soc += IloStepAtEnd(tasks(i, j, TaskMode::CRGf), battery_capacity / 6);
+            }
+
+            model.add(IloAlwaysIn(env, shuttle_soc, tasks(i, j, TaskMode::OUT),
+                          /*min*/ trip_distance,
+                          /*max*/ battery_capacity));
+
+            // Ensure SoC is below soc_threshold for CRGp
+            model.add(IloAlwaysIn(env, shuttle_soc, tasks(i, j, TaskMode::CRGp),
+                                /*min*/ 0,
+                                /*max*/ shuttle_type(cfg, i).soc_threshold));
+        }
+
+        model.add(IloAlwaysIn(env, shuttle_soc, start_time, end_time, 0, battery_capacity));
+
+        // With a charge curve, SOC is also tracked at the start of each slot so that
+        // a charge's height can be looked up from its start SOC and length
+        if (charging) {
+            IloIntArray gains(env);
+            for (int gain : charging->values())
+                gains.add(gain);
+            const IloInt stride = charging->max_slots() + 1;
+
+            IloIntVar soc_at(env, shuttle_states[i].soc, shuttle_states[i].soc);
+            for (int j = 0; j < max_tasks; ++j) {
+                IloIntVar soc_next(env, 0, battery_capacity,
+                                   ("soc_" + std::to_string(i) + "_" + std::to_string(j + 1)).c_str());
+                IloExpr balance(env);
+                balance += soc_at;
+                balance -= trip_distance * IloPresenceOf(env, tasks(i, j, TaskMode::OUT));
+                balance -= trip_distance * IloPresenceOf(env, tasks(i, j, TaskMode::RET));
+                for (TaskMode mode : {TaskMode::CRGp, TaskMode::CRGf}) {
+                    const IloIntervalVar& charge = tasks(i, j, mode);
+                    IloIntExpr height = IloHeightAtEnd(charge, shuttle_soc, 0);
+                    IloIntExpr index = soc_at * stride + IloLengthOf(charge, 0);
+                    model.add(IloIfThen(env, IloPresenceOf(env, charge) == 1, height == IloElement(gains, index)));
+                    balance += height;
+                }
+                model.add(soc_next == balance);
+                balance.end();
+                soc_at = soc_next;
+            }
+        }
+        shuttle_soc.end();
+    }
+
+    // Symmetry breaking: shuttles of the same type that open the horizon in the
+    // same state are interchangeable, so their task start times are ordered
+    // lexicographically, slot by slot
+    families.next("symmetry breaking");
+    for (int q = 0; q < num_shuttles - 1; ++q) {
+        if (cfg.shuttle_type_of[q] != cfg.shuttle_type_of[q+1] || !same_state(shuttle_states[q], shuttle_states[q+1]))
+            continue;
+        IloIntExprArray starts(env), next_starts(env);
+        for (int j = 0; j < max_tasks; ++j) {
+            starts.add(IloStartOf(tasks.master(q, j), end_time));
+            next_starts.add(IloStartOf(tasks.master(q+1, j), end_time));
+        }
+        model.add(IloLexicographic(env, starts, next_starts));
+    }
+
+    // Trip flags counted by the objective
+    families.next("trip flags", long(num_shuttles) * max_tasks);
+    sk.trip_flags.resize(size_t(num_shuttles) * max_tasks);
+    for (int q = 0; q < num_shuttles; ++q) {
+        for (int i = 0; i < max_tasks; ++i) {
+            IloBoolVar& z = sk.trip_flags[size_t(q) * max_tasks + i];
+            z = IloBoolVar(env, ("z_" + std::to_string(q) + "_task_" + std::to_string(i)).c_str());
+            model.add(z >= IloPresenceOf(env, tasks(q, i, TaskMode::OUT)));
+            model.add(z >= IloPresenceOf(env, tasks(q, i, TaskMode::RET)));
+            model.add(z <= IloPresenceOf(env, tasks(q, i, TaskMode::OUT)) + IloPresenceOf(env, tasks(q, i, TaskMode::RET)));
+        }
+    }
+
+    families.finish();
+
+    sk.all_intervals = IloIntervalVarArray(env);
+    for (int q = 0; q < num_shuttles; ++q)
+        for (int i = 0; i < max_tasks; ++i)
+            for (TaskMode mode : ALL_TASK_MODES)
+                sk.all_intervals.add(tasks(q, i, mode));
+
+    return sk;
+}
+
+ShuttleModel build_slot_model(IloEnv env, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                              const std::vector<ShuttleState>& states, Profiler* profiler, ModelCache* cache) {
+    std::vector<ShuttleState> shuttle_states = states.empty() ? initial_states(cfg) : states;
+    for (auto& state : shuttle_states)
+        state.available_from = std::max(state.available_from, cfg.start_time);
+
+    // The skeleton comes from the cache when this env already holds one for the same fleet and horizon
+    ModelSkeleton built;
+    const ModelSkeleton* skeleton = nullptr;
+    uint64_t key = 0;
+    if (cache && cache->env().getImpl() == env.getImpl()) {
+        key = skeleton_key(cfg, shuttle_states);
+        skeleton = cache->find(key);
+    } else {
+        cache = nullptr;
+    }
+    if (!skeleton) {
+        built = build_slot_skeleton(env, cfg, shuttle_states, profiler);
+        skeleton = cache ? &cache->insert(key, built) : &built;
+    }
+
+    ShuttleModel sm;
+    sm.model = IloModel(env);
+    sm.model.add(skeleton->model);
+    sm.tasks = skeleton->tasks;
+    sm.trip_flags = skeleton->trip_flags;
+    sm.all_intervals = skeleton->all_intervals;
+    FamilyTimer families(profiler, sm.model);
+
+    // Unmet demand and waiting time terms of the objective
+    families.next("demand windows");
+    set_demand_items(sm, cfg, demands);
+    IloExpr demand_cost = add_demand_model(env, cfg, skeleton->bounds, sm, families);
+
+    // Minimize the number of trips, unmet demand and waiting time of served requests
+    families.next("objective");
+    IloExpr obj(env);
+    obj += demand_cost;
+    demand_cost.end();
+
+    for (const IloBoolVar& z : sm.trip_flags)
+        obj += delta * z;
+
+    sm.objective = IloMinimize(env, obj);
+    sm.model.add(sm.objective);
+    obj.end();
+    families.finish();
+
+    return sm;
+}
+
+// Interval type "before the first task" of a fresh shuttle in the sequence model
+constexpr IloInt FRESH_START = NUM_TASK_MODES;
+
+// Constraint: type takes one of the allowed values
+IloConstraint type_in(IloEnv env, const IloIntExpr& type, const std::vector<IloInt>& allowed) {
+    IloOr any(env);
+    for (IloInt value : allowed)
+        any.add(type == value);
+    return any;
+}
+
+ShuttleModel build_sequence_model(IloEnv env, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                                  const std::vector<ShuttleState>& states, Profiler* profiler) {
+    const IloInt start_time = cfg.start_time;
+    const IloInt end_time = cfg.end_time;
+    const IloInt num_shuttles = cfg.num_shuttles;
+    const IloInt trip_duration = cfg.trip_duration;
+    const IloInt trip_distance = cfg.trip_distance;
+
+    std::vector<ShuttleState> shuttle_states = states.empty() ? initial_states(cfg) : states;
+    for (auto& state : shuttle_states)
+        state.available_from = std::max(state.available_from, cfg.start_time);
+
+    ShuttleModel sm;
+    sm.model = IloModel(env);
+    sm.sequence = true;
+    IloModel& model = sm.model;
+    FamilyTimer families(profiler, model);
+
+    // Pools are sized from the demand windows
+    families.next("demand windows");
+    set_demand_items(sm, cfg, demands);
+    std::vector<TaskPools> pools;
+    int pool_size = 1;
+    long pool_intervals = 0;
+    for (int q = 0; q < num_shuttles; ++q) {
+        pools.push_back(size_task_pools(shuttle_states[q], cfg, q, sm.windows));
+        pool_size = std::max(pool_size, pools.back().size());
+        pool_intervals += 2L * pools.back().rounds + pools.back().partial_charges + pools.back().full_charges;
+    }
+    sm.tasks = TaskGrid(num_shuttles, pool_size);
+    TaskGrid& tasks = sm.tasks;
+
+    // Optional pool intervals, typed by mode, on one sequence per shuttle
+    families.next("interval variables", pool_intervals + num_shuttles);
+    sm.sequences = IloIntervalSequenceVarArray(env);
+    sm.all_intervals = IloIntervalVarArray(env);
+    for (int q = 0; q < num_shuttles; ++q) {
+        const TaskPools& pool = pools[q];
+        IloIntervalVarArray members(env);
+        IloIntArray types(env);
+        auto create = [&](int k, TaskMode mode, IloInt length) {
+            IloIntervalVar& var = tasks(q, k, mode);
+            var = IloIntervalVar(env, length);
+            var.setOptional();
+            var.setStartMin(shuttle_states[q].available_from);
+            var.setEndMax(end_time);
+            var.setName(("shuttle_" + std::to_string(q) + "_" + task_mode_name(mode) + "_" + std::to_string(k)).c_str());
+            members.add(var);
+            types.add(IloInt(mode));
+            sm.all_intervals.add(var);
+        };
+        for (int k = 0; k < pool.rounds; ++k) {
+            if (k > 0 || !pool.lone_return)
+                create(k, TaskMode::OUT, trip_duration);
+            create(k, TaskMode::RET, trip_duration);
+        }
+        for (int k = 0; k < pool.partial_charges; ++k)
+            create(k, TaskMode::CRGp, 2 * trip_duration);
+        for (int k = 0; k < pool.full_charges; ++k)
+            create(k, TaskMode::CRGf, trip_duration);
+
+        IloIntervalSequenceVar sequence(env, members, types, ("shuttle_" + std::to_string(q)).c_str());
+        sm.sequences.add(sequence);
+        model.add(IloNoOverlap(env, sequence));
+    }
+
+    // Pools are used in index order; an OUT is directly followed by the RET of its round
+    families.next("pool order");
+    for (int q = 0; q < num_shuttles; ++q) {
+        const TaskPools& pool = pools[q];
+        for (int k = 0; k < pool.rounds; ++k) {
+            const IloIntervalVar& ret = tasks(q, k, TaskMode::RET);
+            if (tasks.has(q, k, TaskMode::OUT)) {
+                const IloIntervalVar& out = tasks(q, k, TaskMode::OUT);
+                model.add(IloPresenceOf(env, out) == IloPresenceOf(env, ret));
+                model.add(IloPrevious(env, sm.sequences[q], out, ret));
+            }
+            if (k > 0) {
+                const IloIntervalVar& prev = tasks(q, k-1, TaskMode::RET);
+                model.add(IloPresenceOf(env, ret) <= IloPresenceOf(env, prev));
+                model.add(IloEndBeforeStart(env, prev, tasks(q, k, TaskMode::OUT)));
+            }
+        }
+        for (TaskMode mode : {TaskMode::CRGp, TaskMode::CRGf}) {
+            for (int k = 1; k < pool_size && tasks.has(q, k, mode); ++k) {
+                model.add(IloPresenceOf(env, tasks(q, k, mode)) <= IloPresenceOf(env, tasks(q, k-1, mode)));
+                model.add(IloEndBeforeStart(env, tasks(q, k-1, mode), tasks(q, k, mode)));
+            }
+        }
+
+        // The shuttle's state fixes how it continues: a fresh shuttle first goes
+        // out, one that is away first returns, and one that left a charge must go out again
+        const ShuttleState& state = shuttle_states[q];
+        if (pool.rounds == 0)
+            continue;
+        if (pool.lone_return) {
+            tasks(q, 0, TaskMode::RET).setPresent();
+            model.add(IloFirst(env, sm.sequences[q], tasks(q, 0, TaskMode::RET)));
+        } else if (!state.has_prev) {
+            tasks(q, 0, TaskMode::OUT).setPresent();
+            model.add(IloFirst(env, sm.sequences[q], tasks(q, 0, TaskMode::OUT)));
+        } else if (!can_follow(state.prev_mode, TaskMode::END)) {
+            tasks(q, 0, TaskMode::OUT).setPresent();
+        }
+    }
+
+    // Transition rules on the types of neighbouring intervals of each sequence.
+    // The last task must be one that END may follow.
+    families.next("transitions");
+    for (int q = 0; q < num_shuttles; ++q) {
+        const ShuttleState& state = shuttle_states[q];
+        IloInt first_type = state.has_prev ? IloInt(state.prev_mode) : FRESH_START;
+        for (TaskMode mode : {TaskMode::OUT, TaskMode::RET, TaskMode::CRGp, TaskMode::CRGf}) {
+            std::vector<IloInt> next_types, prev_types;
+            for (TaskMode other : ALL_TASK_MODES) {
+                if (can_follow(mode, other))
+                    next_types.push_back(IloInt(other));
+                if (can_follow(other, mode))
+                    prev_types.push_back(IloInt(other));
+            }
+            if (!state.has_prev && state.allows_first(mode))
+                prev_types.push_back(FRESH_START);
+
+            for (int k = 0; k < pool_size; ++k) {
+                if (!tasks.has(q, k, mode))
+                    continue;
+                const IloIntervalVar& var = tasks(q, k, mode);
+                if (next_types.size() < size_t(NUM_TASK_MODES))
+                    model.add(type_in(env, IloTypeOfNext(sm.sequences[q], var, IloInt(TaskMode::END), next_types[0]),
+                                      next_types));
+                model.add(type_in(env, IloTypeOfPrev(sm.sequences[q], var, first_type, prev_types[0]), prev_types));
+            }
+        }
+    }
+
+    // SOC of each shuttle, as in the slot model
+    families.next("state of charge");
+    for (int q = 0; q < num_shuttles; ++q) {
+        const IloInt battery_capacity = shuttle_type(cfg, q).battery_capacity;
+        IloCumulFunctionExpr shuttle_soc(env);
+        shuttle_soc += IloStep(env, start_time, shuttle_states[q].soc);
+        for (int k = 0; k < pool_size; ++k) {
+            if (tasks.has(q, k, TaskMode::OUT))
+                shuttle_soc -= IloStepAtStart(tasks(q, k, TaskMode::OUT), trip_distance);
+            if (tasks.has(q, k, TaskMode::RET))
+                shuttle_soc -= IloStepAtStart(tasks(q, k, TaskMode::RET), trip_distance);
+            if (tasks.has(q, k, TaskMode::CRGp))
+                shuttle_soc += IloStepAtEnd(tasks(q, k, TaskMode::CRGp), soc_delta(TaskMode::CRGp, cfg, q));
+            if (tasks.has(q, k, TaskMode::CRGf))
+                shuttle_soc += IloStepAtEnd(tasks(q, k, TaskMode::CRGf), soc_delta(TaskMode::CRGf, cfg, q));
+        }
+        for (int k = 0; k < pool_size; ++k) {
+            if (tasks.has(q, k, TaskMode::OUT))
+                model.add(IloAlwaysIn(env, shuttle_soc, tasks(q, k, TaskMode::OUT), trip_distance, battery_capacity));
+            if (tasks.has(q, k, TaskMode::CRGp))
+                model.add(IloAlwaysIn(env, shuttle_soc, tasks(q, k, TaskMode::CRGp), 0,
+                                      shuttle_type(cfg, q).soc_threshold));
+        }
+        model.add(IloAlwaysIn(env, shuttle_soc, start_time, end_time, 0, battery_capacity));
+        shuttle_soc.end();
+    }
+
+    std::vector<TaskBounds> bounds;
+    for (int q = 0; q < num_shuttles; ++q)
+        bounds.push_back(compute_round_bounds(shuttle_states[q], cfg.end_time, cfg.trip_duration, pools[q], pool_size));
+    for (int q = 0; q < num_shuttles; ++q) {
+        for (int k = 0; k < pools[q].rounds; ++k) {
+            if (tasks.has(q, k, TaskMode::OUT)) {
+                tasks(q, k, TaskMode::OUT).setStartMin(bounds[q].out_earliest[k]);
+                tasks(q, k, TaskMode::OUT).setStartMax(bounds[q].out_latest[k]);
+            }
+            tasks(q, k, TaskMode::RET).setStartMin(bounds[q].ret_earliest[k]);
+            tasks(q, k, TaskMode::RET).setStartMax(bounds[q].ret_latest[k]);
+        }
+    }
+    IloExpr demand_cost = add_demand_model(env, cfg, bounds, sm, families);
+
+    // Symmetry breaking: interchangeable shuttles (same type and state, hence
+    // the same pools) order their round start times lexicographically
+    families.next("symmetry breaking");
+    for (int q = 0; q < num_shuttles - 1; ++q) {
+        if (cfg.shuttle_type_of[q] != cfg.shuttle_type_of[q+1] || !same_state(shuttle_states[q], shuttle_states[q+1]))
+            continue;
+        IloIntExprArray starts(env), next_starts(env);
+        for (int k = 0; k < pools[q].rounds; ++k) {
+            TaskMode first = tasks.has(q, k, TaskMode::OUT) ? TaskMode::OUT : TaskMode::RET;
+            starts.add(IloStartOf(tasks(q, k, first), end_time));
+            next_starts.add(IloStartOf(tasks(q+1, k, first), end_time));
+        }
+        model.add(IloLexicographic(env, starts, next_starts));
+    }
+
+    // Minimize the number of trips, unmet demand and waiting time of served requests
+    families.next("objective");
+    IloExpr obj(env);
+    obj += demand_cost;
+    demand_cost.end();
+    for (int q = 0; q < num_shuttles; ++q)
+        for (int k = 0; k < pools[q].rounds; ++k)
+            for (TaskMode mode : {TaskMode::OUT, TaskMode::RET})
+                if (tasks.has(q, k, mode))
+                    obj += delta * IloPresenceOf(env, tasks(q, k, mode));
+    sm.objective = IloMinimize(env, obj);
+    model.add(sm.objective);
+    obj.end();
+    families.finish();
+
+    return sm;
+}
+
+} // namespace
+
+ShuttleModel build_model(IloEnv env, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                         const std::vector<ShuttleState>& states, Profiler* profiler, ModelCache* cache) {
+    // Sequence-model pools are sized from the demand, so there is no skeleton to reuse
+    if (cfg.model_type == "sequence")
+        return build_sequence_model(env, cfg, demands, states, profiler);
+    return build_slot_model(env, cfg, demands, states, profiler, cache);
+}
+
+uint64_t skeleton_key(const ProblemConfig& cfg, const std::vector<ShuttleState>& states) {
+    // FNV-1a over everything the skeleton is built from
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](double value) {
+        unsigned char bytes[sizeof(double)];
+        std::memcpy(bytes, &value, sizeof(double));
+        for (unsigned char byte : bytes) {
+            hash ^= byte;
+            hash *= 1099511628211ull;
+        }
+    };
+    // The charge tables are built from the curve, the capacity, time_res and
+    // max_charge: two configs with the same curve but a different time_res
+    // charge differently per slot
+    for (int value : {cfg.start_time, cfg.end_time, cfg.num_shuttles, cfg.max_tasks, cfg.trip_duration,
+                      cfg.trip_distance, cfg.max_charge, cfg.time_res})
+        mix(value);
+    for (const auto& point : cfg.charge_curve) {
+        mix(point.first);
+        mix(point.second);
+    }
+    for (int q = 0; q < cfg.num_shuttles; ++q) {
+        const ShuttleType& type = shuttle_type(cfg, q);
+        mix(cfg.shuttle_type_of[q]);
+        mix(type.battery_capacity);
+        mix(type.soc_threshold);
+        mix(type.charging != nullptr);
+    }
+    for (const ShuttleState& state : states) {
+        mix(state.available_from);
+        mix(state.soc);
+        mix(state.has_prev);
+        mix(int(state.prev_mode));
+    }
+    return hash;
+}
+
+ModelCache::ModelCache(int max_runs) : env_(), max_runs_(max_runs) {}
+
+ModelCache::~ModelCache() {
+    env_.end();
+}
+
+IloEnv ModelCache::next_env() {
+    if (runs_ >= max_runs_) {
+        skeletons_.clear();
+        env_.end();
+        env_ = IloEnv();
+        runs_ = 0;
+    }
+    ++runs_;
+    return env_;
+}
+
+const ModelSkeleton* ModelCache::find(uint64_t key) const {
+    auto it = skeletons_.find(key);
+    return it == skeletons_.end() ? nullptr : &it->second;
+}
+
+const ModelSkeleton& ModelCache::insert(uint64_t key, const ModelSkeleton& skeleton) {
+    return skeletons_[key] = skeleton;
+}
+
+namespace {
+
+// Grid slot of each task in one shuttle's task list, -1 for tasks the model cannot hold.
+// Slot model: the task's position, up to the last slot which is reserved for END,
+// and nothing after the first END (lists padded with several ENDs).
+// Sequence model: the next pool interval of the task's mode; a RET belongs to the
+// round of the OUT before it.
+std::vector<int> grid_slots(const ShuttleModel& sm, int q, const std::vector<ScheduledTask>& hint) {
+    const TaskGrid& tasks = sm.tasks;
+    std::vector<int> slots(hint.size(), -1);
+    if (!sm.sequence) {
+        for (int j = 0; j < int(hint.size()) && j < tasks.max_tasks(); ++j) {
+            if (j == tasks.max_tasks() - 1 && hint[j].mode != TaskMode::END)
+                break;
+            slots[j] = j;
+            if (hint[j].mode == TaskMode::END)
+                break;
+        }
+        return slots;
+    }
+    int used[NUM_TASK_MODES] = {0, 0, 0, 0, 0};
+    int round = 0;
+    for (size_t j = 0; j < hint.size(); ++j) {
+        TaskMode mode = hint[j].mode;
+        int k = mode == TaskMode::OUT || mode == TaskMode::RET ? round : used[int(mode)]++;
+        if (mode == TaskMode::RET)
+            ++round;
+        if (mode != TaskMode::END && k < tasks.max_tasks() && tasks.has(q, k, mode))
+            slots[j] = k;
+    }
+    return slots;
+}
+
+// Index of (shuttle, slot, mode) in a flat per-grid table
+size_t grid_key(const TaskGrid& tasks, int q, int i, TaskMode mode) {
+    return (size_t(q) * tasks.max_tasks() + i) * NUM_TASK_MODES + int(mode);
+}
+
+} // namespace
+
+IloSolution make_starting_point(IloEnv env, const ShuttleModel& sm,
+                                const std::vector<std::vector<ScheduledTask>>& hint) {
+    const TaskGrid& tasks = sm.tasks;
+    IloSolution sol(env);
+    for (int q = 0; q < tasks.num_shuttles() && q < int(hint.size()); ++q) {
+        // Sequence model: pool intervals the hint does not use are absent
+        if (sm.sequence)
+            for (int k = 0; k < tasks.max_tasks(); ++k)
+                for (TaskMode mode : ALL_TASK_MODES)
+                    if (tasks.has(q, k, mode)) {
+                        sol.add(tasks(q, k, mode));
+                        sol.setAbsent(tasks(q, k, mode));
+                    }
+
+        std::vector<int> slots = grid_slots(sm, q, hint[q]);
+        int closed_at = tasks.max_tasks();
+        for (size_t j = 0; j < hint[q].size(); ++j) {
+            const ScheduledTask& t = hint[q][j];
+            if (slots[j] < 0)
+                continue;
+            if (!sm.sequence)
+                for (TaskMode mode : ALL_TASK_MODES) {
+                    sol.add(tasks(q, slots[j], mode));
+                    sol.setAbsent(tasks(q, slots[j], mode));
+                }
+            const IloIntervalVar& var = tasks(q, slots[j], t.mode);
+            sol.setPresent(var);
+            sol.setStart(var, t.start);
+            sol.setEnd(var, t.end);
+            if (t.mode == TaskMode::END)
+                closed_at = slots[j];
+        }
+
+        // Slot model: the slots after the hint's END are empty
+        if (!sm.sequence)
+            for (int k = closed_at + 1; k < tasks.max_tasks(); ++k) {
+                sol.add(tasks.master(q, k));
+                sol.setAbsent(tasks.master(q, k));
+            }
+    }
+    return sol;
+}
+
+IloSolution make_starting_point(IloEnv env, const ShuttleModel& sm, const Schedule& schedule) {
+    IloSolution sol = make_starting_point(env, sm, schedule.shuttles);
+
+    // Passengers boarded per (shuttle, slot, item)
+    std::vector<int> item_of(schedule.served_by.size());
+    for (size_t d = 0; d < item_of.size(); ++d)
+        item_of[d] = int(d);
+    for (size_t g = 0; g < sm.groups.size(); ++g)
+        for (size_t d : sm.groups[g].members)
+            item_of[d] = int(g);
+
+    std::vector<std::vector<int>> slots;
+    for (int q = 0; q < sm.tasks.num_shuttles() && q < int(schedule.shuttles.size()); ++q)
+        slots.push_back(grid_slots(sm, q, schedule.shuttles[q]));
+
+    std::map<std::tuple<int, int, int>, IloInt> boarded;
+    for (size_t d = 0; d < schedule.served_by.size(); ++d) {
+        auto served = schedule.served_by[d];
+        if (served.first >= 0 && served.first < int(slots.size()) && slots[served.first][served.second] >= 0)
+            ++boarded[std::make_tuple(served.first, slots[served.first][served.second], item_of[d])];
+    }
+
+    for (size_t k = 0; k < sm.assign_index.arcs.size(); ++k) {
+        const auto& arc = sm.assign_index.arcs[k];
+        auto it = boarded.find(std::make_tuple(arc.shuttle, arc.task, arc.item));
+        sol.add(sm.assign[k]);
+        sol.setValue(sm.assign[k], it == boarded.end() ? 0 : it->second);
+    }
+    return sol;
+}
+
+// Values is IloCP (current solution) or IloSolution (stored one); both expose
+// the same isPresent/getStart/getEnd/getValue accessors. position maps
+// grid_key(shuttle, slot, mode) to the task's position in the shuttle's list.
+template <class Values>
+static std::vector<std::pair<int, int>> extract_assignments(const Values& cp, const ShuttleModel& sm, size_t num_demands,
+                                                            const std::vector<int>& position) {
+    std::vector<std::pair<int, int>> served_by(num_demands, {-1, -1});
+    std::vector<size_t> next_member(sm.groups.size(), 0);
+    for (size_t k = 0; k < sm.assign_index.arcs.size(); ++k) {
+        const auto& arc = sm.assign_index.arcs[k];
+        IloInt boarded = IloInt(cp.getValue(sm.assign[k]) + 0.5);
+        std::pair<int, int> trip(arc.shuttle,
+                                 position[grid_key(sm.tasks, arc.shuttle, arc.task, trip_mode(sm.windows[arc.item].direction))]);
+        if (!sm.aggregated) {
+            if (boarded > 0)
+                served_by[arc.item] = trip;
+            continue;
+        }
+        const auto& members = sm.groups[arc.item].members;
+        size_t& next = next_member[arc.item];
+        for (IloInt b = 0; b < boarded && next < members.size(); ++b)
+            served_by[members[next++]] = trip;
+    }
+    return served_by;
+}
+
+template <class Values>
+static Schedule read_schedule(const Values& cp, const ShuttleModel& sm, size_t num_demands) {
+    const TaskGrid& tasks = sm.tasks;
+    Schedule schedule;
+    schedule.shuttles.resize(tasks.num_shuttles());
+
+    std::vector<int> position(size_t(tasks.num_shuttles()) * tasks.max_tasks() * NUM_TASK_MODES, -1);
+    for (int q = 0; q < tasks.num_shuttles(); ++q) {
+        auto& list = schedule.shuttles[q];
+        std::vector<size_t> keys;
+        for (int j = 0; j < tasks.max_tasks(); ++j) {
+            for (TaskMode mode : ALL_TASK_MODES) {
+                if (!tasks.has(q, j, mode))
+                    continue;
+                const IloIntervalVar& var = tasks(q, j, mode);
+                if (cp.isPresent(var)) {
+                    keys.push_back(grid_key(tasks, q, j, mode));
+                    list.push_back({mode, j, int(cp.getStart(var)), int(cp.getEnd(var))});
+                }
+            }
+        }
+
+        // Sequence model: pools interleave, so order by time and number the tasks
+        std::vector<size_t> order(list.size());
+        for (size_t k = 0; k < order.size(); ++k)
+            order[k] = k;
+        if (sm.sequence)
+            std::stable_sort(order.begin(), order.end(),
+                             [&](size_t a, size_t b) { return list[a].start < list[b].start; });
+        std::vector<ScheduledTask> sorted;
+        for (size_t k : order) {
+            position[keys[k]] = int(sorted.size());
+            sorted.push_back(list[k]);
+            if (sm.sequence)
+                sorted.back().slot = int(sorted.size()) - 1;
+        }
+        list = std::move(sorted);
+    }
+
+    schedule.served_by = extract_assignments(cp, sm, num_demands, position);
+    return schedule;
+}
+
+Schedule extract_schedule(const IloCP& cp, const ShuttleModel& sm, size_t num_demands) {
+    return read_schedule(cp, sm, num_demands);
+}
+
+Schedule extract_schedule(const IloSolution& solution, const ShuttleModel& sm, size_t num_demands) {
+    return read_schedule(solution, sm, num_demands);
+}
@@ -0,0 +1,109 @@
+#include "network.hpp"
+
+#include <numeric>
+#include <stdexcept>
+
+TimeExpandedNetwork build_network(const ProblemConfig& cfg, int shuttle) {
+    const ShuttleType& type = shuttle_type(cfg, shuttle);
+    const int cap = type.battery_capacity;
+    const int trip = cfg.trip_distance;
+    const int tau = cfg.trip_duration;
+
+    TimeExpandedNetwork net;
+    net.first_time = cfg.start_time;
+    net.last_time = cfg.end_time;
+    net.soc_unit = std::gcd(std::gcd(cap, trip), std::gcd(soc_delta(TaskMode::CRGp, cfg, shuttle), soc_delta(TaskMode::CRGf, cfg, shuttle)));
+    if (net.soc_unit <= 0)
+        throw std::invalid_argument("build_network: battery and trip energies must be positive");
+    net.levels = cap / net.soc_unit + 1;
+    const int unit = net.soc_unit;
+    const int num_times = cfg.end_time - cfg.start_time + 1;
+    const size_t num_nodes = size_t(num_times) * NUM_LOCATIONS * net.levels;
+    net.source = net.node(cfg.start_time, Location::HubOutOnly, cap / unit);
+
+    // Every arc the rules allow, from every state
+    std::vector<NetworkArc> all;
+    for (int t = cfg.start_time; t < cfg.end_time; ++t) {
+        for (int loc = 0; loc < NUM_LOCATIONS; ++loc) {
+            Location location = Location(loc);
+            for (int l = 0; l < net.levels; ++l) {
+                int from = net.node(t, location, l);
+                int soc = l * unit;
+                auto task = [&](TaskMode mode, int duration, Location to) {
+                    int after = soc + soc_delta(mode, cfg, shuttle);
+                    if (t + duration <= cfg.end_time)
+                        all.push_back({from, net.node(t + duration, to, after / unit), false, mode, t, t + duration});
+                };
+
+                all.push_back({from, net.node(t + 1, location, l), true, TaskMode::END, t, t + 1});
+                // The model's OUT keeps at least trip_distance during the trip, i.e. for the return
+                if (location != Location::Away && soc - trip >= trip)
+                    task(TaskMode::OUT, tau, Location::Away);
+                if (location == Location::Away && soc >= trip)
+                    task(TaskMode::RET, tau, Location::Hub);
+                if (location == Location::Hub && soc <= type.soc_threshold &&
+                    soc + soc_delta(TaskMode::CRGp, cfg, shuttle) <= cap)
+                    task(TaskMode::CRGp, 2 * tau, Location::HubOutOnly);
+                if ((location == Location::Hub || location == Location::HubCharging) &&
+                    soc + soc_delta(TaskMode::CRGf, cfg, shuttle) <= cap)
+                    task(TaskMode::CRGf, tau, Location::HubCharging);
+            }
+        }
+    }
+
+    // Keep states reachable from the source that can still end at the hub.
+    // Arcs go forward in time, so one pass in each direction suffices.
+    std::vector<char> forward(num_nodes, 0), backward(num_nodes, 0);
+    forward[net.source] = 1;
+    for (const auto& arc : all)         // generated in non-decreasing start time
+        if (forward[arc.from])
+            forward[arc.to] = 1;
+    for (int l = 0; l < net.levels; ++l)
+        backward[net.node(cfg.end_time, Location::Hub, l)] = 1;
+    for (auto it = all.rbegin(); it != all.rend(); ++it)
+        if (backward[it->to])
+            backward[it->from] = 1;
+
+    net.out_arcs.resize(num_nodes);
+    net.in_arcs.resize(num_nodes);
+    for (const auto& arc : all) {
+        if (!forward[arc.from] || !backward[arc.to])
+            continue;
+        int a = int(net.arcs.size());
+        net.arcs.push_back(arc);
+        net.out_arcs[arc.from].push_back(a);
+        net.in_arcs[arc.to].push_back(a);
+    }
+    return net;
+}
+
+std::vector<std::vector<ScheduledTask>> decompose_flow(const TimeExpandedNetwork& net, const ProblemConfig& cfg,
+                                                       const std::vector<int>& flow) {
+    std::vector<int> remaining = flow;
+    std::vector<std::vector<ScheduledTask>> shuttles(cfg.num_shuttles);
+
+    for (int q = 0; q < cfg.num_shuttles; ++q) {
+        auto& tasks = shuttles[q];
+        int node = net.source;
+        int time = net.first_time;
+        while (time < net.last_time) {
+            int next = -1;
+            for (int a : net.out_arcs[node])
+                if (remaining[a] > 0) {
+                    next = a;
+                    break;
+                }
+            if (next < 0)
+                throw std::runtime_error("decompose_flow: flow is not conserved");
+            --remaining[next];
+            const NetworkArc& arc = net.arcs[next];
+            if (!arc.wait)
+                tasks.push_back({arc.mode, int(tasks.size()), arc.start, arc.end});
+            node = arc.to;
+            time = arc.end;
+        }
+
+        pad_with_end(tasks, tasks.empty() ? net.first_time : tasks.back().end, cfg);
+    }
+    return shuttles;
+}
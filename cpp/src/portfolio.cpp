@@ -0,0 +1,197 @@
+#include "portfolio.hpp"
+
+#include <ilcp/cp.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "heuristic.hpp"
+#include "model.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Best result across members
+struct Incumbent {
+    std::mutex mutex;
+    bool found = false;
+    double objective = std::numeric_limits<double>::infinity();
+    double bound = -std::numeric_limits<double>::infinity();
+    Schedule schedule;
+    size_t owner = 0;           // member that found it
+    std::atomic<bool> stop{false};
+};
+
+// A member restarts early for a better incumbent of another member only after
+// searching this long, so that a stream of small improvements does not keep
+// it from getting anywhere
+constexpr double MIN_SEARCH_SECONDS = 2.0;
+
+// Publishes each incumbent of the member as soon as it is found. Aborts the
+// member's search when another member has closed the search, or holds a
+// solution better than the member's cutoff and own incumbent, so that the
+// member restarts from it under the tighter cutoff.
+class ShareCallback : public IloCP::Callback {
+public:
+    ShareCallback(size_t member, const ShuttleModel& sm, size_t num_demands, Incumbent& best)
+        : member_(member), sm_(sm), num_demands_(num_demands), best_(best) {}
+
+    // Called before each solve with the objective cutoff it runs under
+    void start_solve(double cutoff) {
+        cutoff_ = cutoff;
+        started_ = Clock::now();
+        restarted_ = false;
+    }
+
+    // True if the last solve was aborted for another member's incumbent
+    bool restarted() const { return restarted_; }
+
+    void invoke(IloCP cp, IloCP::Callback::Reason reason) override {
+        if (reason == IloCP::Callback::Solution) {
+            double objective = cp.getObjValue();
+            cutoff_ = std::min(cutoff_, objective);
+            std::lock_guard<std::mutex> lock(best_.mutex);
+            if (objective < best_.objective) {
+                best_.found = true;
+                best_.objective = objective;
+                best_.schedule = extract_schedule(cp, sm_, num_demands_);
+                best_.owner = member_;
+            }
+        } else if (reason == IloCP::Callback::Periodic) {
+            if (best_.stop) {
+                cp.abortSearch();
+                return;
+            }
+            if (std::chrono::duration<double>(Clock::now() - started_).count() < MIN_SEARCH_SECONDS)
+                return;
+            std::lock_guard<std::mutex> lock(best_.mutex);
+            if (best_.objective < cutoff_) {
+                restarted_ = true;
+                cp.abortSearch();
+            }
+        }
+    }
+
+private:
+    size_t member_;
+    const ShuttleModel& sm_;
+    size_t num_demands_;
+    Incumbent& best_;
+    double cutoff_ = std::numeric_limits<double>::infinity();
+    Clock::time_point started_;
+    bool restarted_ = false;
+};
+
+void run_member(size_t m, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                Incumbent& best, Clock::time_point deadline, std::mutex& log_mutex, std::ostream& log) {
+    const PortfolioMember& member = cfg.portfolio_members[m];
+    ProblemConfig member_cfg = cfg;
+    member_cfg.search_type = member.search_type;
+    member_cfg.workers = member.workers;
+    member_cfg.random_seed = member.random_seed;
+    member_cfg.log_verbosity = "Quiet";
+
+    IloEnv env;
+    try {
+        ShuttleModel sm = build_model(env, member_cfg, demands);
+        IloCP cp(sm.model);
+        configure_solver(cp, sm, member_cfg);
+        cp.setOut(env.getNullStream());
+        ShareCallback share(m, sm, demands.size(), best);
+        cp.addCallback(&share);
+
+        auto start = Clock::now();
+        double round_length = std::chrono::duration<double>(deadline - start).count() / cfg.portfolio_rounds;
+        IloConstraint cutoff;
+        for (int round = 0; round < cfg.portfolio_rounds && !best.stop;) {
+            auto round_end = std::min(deadline, start + std::chrono::duration_cast<Clock::duration>(
+                                                            std::chrono::duration<double>(round_length * (round + 1))));
+            double seconds = std::chrono::duration<double>(round_end - Clock::now()).count();
+            if (seconds <= 0) {
+                ++round;
+                continue;
+            }
+            cp.setParameter(IloCP::TimeLimit, seconds);
+
+            // Each solve starts afresh: continue from the best schedule of any
+            // member, and only accept solutions at least as good
+            {
+                std::lock_guard<std::mutex> lock(best.mutex);
+                if (best.found) {
+                    cp.setStartingPoint(make_starting_point(env, sm, best.schedule));
+                    if (cutoff.getImpl())
+                        sm.model.remove(cutoff);
+                    cutoff = sm.objective.getExpr() <= best.objective;
+                    sm.model.add(cutoff);
+                    share.start_solve(best.objective);
+                } else {
+                    if (round == 0 && cfg.warm_start)
+                        cp.setStartingPoint(make_starting_point(env, sm, greedy_schedule(cfg, demands)));
+                    share.start_solve(std::numeric_limits<double>::infinity());
+                }
+            }
+
+            // Incumbents reach best through the callback; the cutoff keeps bounds valid
+            bool found = cp.solve();
+            bool optimal = cp.getStatus() == IloAlgorithm::Optimal;
+            // A restart for another member's incumbent stays in the same round
+            if (!share.restarted())
+                ++round;
+            std::lock_guard<std::mutex> lock(best.mutex);
+            if (found)
+                best.bound = std::max(best.bound, double(cp.getObjBound()));
+            double gap = best.found && best.objective != 0
+                ? std::fabs(best.objective - best.bound) / std::fabs(best.objective) : 0.0;
+            if (optimal || (best.found && cfg.relative_gap >= 0 && gap <= cfg.relative_gap))
+                best.stop = true;
+
+            std::lock_guard<std::mutex> log_lock(log_mutex);
+            log << "Portfolio round " << round << ", member " << m << " (" << member.search_type << ", "
+                << member.workers << " workers): "
+                << (found ? "objective " + std::to_string(cp.getObjValue()) : std::string("no solution"))
+                << (optimal ? " (optimal)" : "") << (share.restarted() ? ", restarted for a better incumbent" : "")
+                << "; best " << best.objective << std::endl;
+        }
+        cp.removeCallback(&share);
+    } catch (IloException& e) {
+        std::lock_guard<std::mutex> log_lock(log_mutex);
+        log << "Portfolio member " << m << " failed: " << e.getMessage() << std::endl;
+    }
+    env.end();
+}
+
+} // namespace
+
+SolveResult solve_portfolio(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands, std::ostream& log) {
+    auto t0 = Clock::now();
+    auto deadline = t0 + std::chrono::seconds(cfg.time_limit);
+    Incumbent best;
+    std::mutex log_mutex;
+
+    log << "Portfolio of " << cfg.portfolio_members.size() << " members, " << cfg.portfolio_rounds
+        << " rounds." << std::endl;
+    std::vector<std::thread> threads;
+    for (size_t m = 0; m < cfg.portfolio_members.size(); ++m)
+        threads.emplace_back(run_member, m, std::cref(cfg), std::cref(demands), std::ref(best), deadline,
+                             std::ref(log_mutex), std::ref(log));
+    for (auto& t : threads)
+        t.join();
+
+    SolveResult result;
+    result.found = result.has_objective = best.found;
+    if (best.found) {
+        result.objective = best.objective;
+        result.has_bound = std::isfinite(best.bound);
+        result.bound = result.has_bound ? best.bound : 0;
+        result.schedule = best.schedule;
+        log << "Portfolio best: " << best.objective << " from member " << best.owner << " ("
+            << cfg.portfolio_members[best.owner].search_type << ")" << std::endl;
+    }
+    result.solve_time = std::chrono::duration<double>(Clock::now() - t0).count();
+    return result;
+}
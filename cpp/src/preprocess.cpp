@@ -0,0 +1,155 @@
+#include "preprocess.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+bool TaskBounds::allows(Direction direction, int i, int lo, int hi) const {
+    bool outbound = direction == Direction::Outbound;
+    int earliest = outbound ? out_earliest[i] : ret_earliest[i];
+    int latest = outbound ? out_latest[i] : ret_latest[i];
+    return std::max(earliest, lo) <= std::min(latest, hi);
+}
+
+TaskBounds compute_task_bounds(const ShuttleState& state, int end_time, int trip_duration, int max_tasks) {
+    TaskBounds bounds;
+    bounds.out_earliest.resize(max_tasks);
+    bounds.out_latest.resize(max_tasks);
+    bounds.ret_earliest.resize(max_tasks);
+    bounds.ret_latest.resize(max_tasks);
+
+    // Modes reachable at each index from the shuttle's state, and modes from
+    // which the shuttle's END can still be reached by the last slot
+    std::vector<std::vector<bool>> fwd(max_tasks, std::vector<bool>(NUM_TASK_MODES, false));
+    std::vector<std::vector<bool>> bwd(max_tasks, std::vector<bool>(NUM_TASK_MODES, false));
+    for (TaskMode m : ALL_TASK_MODES)
+        fwd[0][int(m)] = state.allows_first(m);
+    for (int i = 1; i < max_tasks; ++i)
+        for (TaskMode p : ALL_TASK_MODES)
+            if (fwd[i-1][int(p)])
+                for (TaskMode m : ALL_TASK_MODES)
+                    if (can_follow(p, m))
+                        fwd[i][int(m)] = true;
+    for (int i = 0; i < max_tasks; ++i)
+        bwd[i][int(TaskMode::END)] = true;
+    for (int i = max_tasks - 2; i >= 0; --i)
+        for (TaskMode m : ALL_TASK_MODES)
+            for (TaskMode n : ALL_TASK_MODES)
+                if (can_follow(m, n) && bwd[i+1][int(n)])
+                    bwd[i][int(m)] = true;
+
+    for (int i = 0; i < max_tasks; ++i) {
+        // All previous tasks are trips or charges, each at least one trip long
+        int earliest = state.available_from + i * trip_duration;
+        bounds.out_earliest[i] = earliest;
+        bounds.ret_earliest[i] = earliest;
+
+        // An OUT must leave room for its RET
+        bounds.out_latest[i] = end_time - 2 * trip_duration;
+        bounds.ret_latest[i] = end_time - trip_duration;
+
+        int out = int(TaskMode::OUT), ret = int(TaskMode::RET);
+        if (!(fwd[i][out] && bwd[i][out]))
+            bounds.out_latest[i] = earliest - 1;
+        if (!(fwd[i][ret] && bwd[i][ret]))
+            bounds.ret_latest[i] = earliest - 1;
+    }
+    return bounds;
+}
+
+TaskPools size_task_pools(const ShuttleState& state, const ProblemConfig& cfg, int shuttle,
+                          const std::vector<TripWindow>& items) {
+    TaskPools pools;
+    if (state.has_prev && state.prev_mode == TaskMode::END)
+        return pools;
+    const int tau = cfg.trip_duration;
+    const int from = state.available_from;
+    pools.lone_return = state.has_prev && state.prev_mode == TaskMode::OUT;
+    const int lone = pools.lone_return ? 1 : 0;
+
+    // Boarding times at least a trip apart inside the union of the item windows,
+    // packed from the left
+    std::vector<std::pair<int, int>> spans;
+    for (const TripWindow& w : items) {
+        int lo = std::max(w.earliest, from);
+        int hi = std::min(w.latest, cfg.end_time - tau);
+        if (lo <= hi)
+            spans.push_back({lo, hi});
+    }
+    std::sort(spans.begin(), spans.end());
+    int boarding = 0;
+    long next = std::numeric_limits<long>::min();
+    for (const auto& span : spans) {
+        long t = std::max<long>(span.first, next);
+        if (t > span.second)
+            continue;
+        int n = int((span.second - t) / tau) + 1;
+        boarding += n;
+        next = t + long(n) * tau;
+    }
+
+    int fit = lone + std::max(0, cfg.end_time - from - lone * tau) / (2 * tau);
+    pools.rounds = std::min(fit, lone + 1 + boarding);
+
+    // The battery never exceeds its capacity, so the charged energy is at most
+    // the room left at the start plus what the trips consume
+    long energy = long(shuttle_type(cfg, shuttle).battery_capacity) - state.soc
+                + 2L * cfg.trip_distance * pools.rounds;
+    int slots = std::max(0, cfg.end_time - from) / tau;
+    int partial_gain = soc_delta(TaskMode::CRGp, cfg, shuttle);
+    int full_gain = soc_delta(TaskMode::CRGf, cfg, shuttle);
+    if (partial_gain > 0)
+        pools.partial_charges = int(std::min<long>({long(pools.rounds - lone), slots / 2L, energy / partial_gain}));
+    if (full_gain > 0)
+        pools.full_charges = int(std::min<long>(slots, energy / full_gain));
+    return pools;
+}
+
+TaskBounds compute_round_bounds(const ShuttleState& state, int end_time, int trip_duration,
+                                const TaskPools& pools, int size) {
+    TaskBounds bounds;
+    bounds.out_earliest.resize(size);
+    bounds.out_latest.resize(size);
+    bounds.ret_earliest.resize(size);
+    bounds.ret_latest.resize(size);
+    const int lone = pools.lone_return ? 1 : 0;
+
+    for (int k = 0; k < size; ++k) {
+        // Earlier rounds take two trips each, the lone return one
+        int out_earliest = state.available_from + (2 * k - lone) * trip_duration;
+        bounds.out_earliest[k] = out_earliest;
+        bounds.out_latest[k] = end_time - 2 * trip_duration;
+        bounds.ret_earliest[k] = std::max(state.available_from, out_earliest + trip_duration);
+        bounds.ret_latest[k] = end_time - trip_duration;
+
+        if (k >= pools.rounds || (k == 0 && pools.lone_return))
+            bounds.out_latest[k] = bounds.out_earliest[k] - 1;
+        if (k >= pools.rounds)
+            bounds.ret_latest[k] = bounds.ret_earliest[k] - 1;
+    }
+    return bounds;
+}
+
+AssignmentIndex build_assignment_index(const std::vector<TaskBounds>& bounds, int max_tasks,
+                                       const std::vector<TripWindow>& items) {
+    int num_shuttles = int(bounds.size());
+    AssignmentIndex index;
+    index.max_tasks = max_tasks;
+    index.by_task.resize(size_t(num_shuttles) * max_tasks);
+    index.by_item.resize(items.size());
+
+    for (size_t d = 0; d < items.size(); ++d) {
+        const TripWindow& w = items[d];
+        for (int q = 0; q < num_shuttles; ++q) {
+            for (int i = 0; i < max_tasks; ++i) {
+                if (!bounds[q].allows(w.direction, i, w.earliest, w.latest))
+                    continue;
+                int arc = int(index.arcs.size());
+                index.arcs.push_back({q, i, int(d)});
+                index.by_task[size_t(q) * max_tasks + i].push_back(arc);
+                index.by_item[d].push_back(arc);
+            }
+        }
+    }
+    return index;
+}
@@ -0,0 +1,281 @@
+#include "presolve.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <utility>
+
+namespace {
+
+// Same weights as the CP objective
+constexpr double alpha = 100;
+constexpr double gamma = 1000000;
+constexpr double delta = 1;
+
+// Best range gained per slot of charging, over every start SOC and length
+double max_charge_rate(const ProblemConfig& cfg, int shuttle) {
+    const ShuttleType& type = shuttle_type(cfg, shuttle);
+    if (!type.charging)
+        return std::max(double(soc_delta(TaskMode::CRGp, cfg, shuttle)) / (2 * cfg.trip_duration),
+                        double(soc_delta(TaskMode::CRGf, cfg, shuttle)) / cfg.trip_duration);
+    const ChargeTable& table = *type.charging;
+    double rate = 0;
+    for (int slots = 1; slots <= table.max_slots(); ++slots)
+        for (int soc = 0; soc <= table.capacity(); ++soc)
+            rate = std::max(rate, double(table.gain(soc, slots)) / slots);
+    return rate;
+}
+
+// Trips one fresh shuttle can drive: each takes trip_duration slots and
+// trip_distance km, and the battery can only be topped up between trips
+int max_trips(const ProblemConfig& cfg, int shuttle) {
+    int horizon = cfg.end_time - cfg.start_time;
+    int trips = horizon / cfg.trip_duration;
+    if (cfg.model_type == "slots")
+        trips = std::min(trips, cfg.max_tasks - 1);
+    if (cfg.trip_distance > 0) {
+        // trips * distance <= capacity + rate * (horizon - trips * duration)
+        double rate = max_charge_rate(cfg, shuttle);
+        double capacity = shuttle_type(cfg, shuttle).battery_capacity;
+        trips = std::min(trips, int((capacity + rate * horizon) / (cfg.trip_distance + rate * cfg.trip_duration)));
+    }
+    return std::max(trips, 0);
+}
+
+// Most passengers boardable when every slot in [lo, hi] offers `capacity` seats:
+// earliest-deadline-first is optimal for unit items with pickup windows
+int max_boardable(std::vector<std::pair<int, int>> windows, int lo, int hi, int capacity) {
+    std::sort(windows.begin(), windows.end());
+    std::priority_queue<int, std::vector<int>, std::greater<int>> waiting;
+    size_t next = 0;
+    int boarded = 0;
+    for (int s = lo; s <= hi; ++s) {
+        while (next < windows.size() && windows[next].first <= s)
+            waiting.push(windows[next++].second);
+        while (!waiting.empty() && waiting.top() < s)
+            waiting.pop();
+        for (int seat = 0; seat < capacity && !waiting.empty(); ++seat, ++boarded)
+            waiting.pop();
+    }
+    return boarded;
+}
+
+// Trips needed to carry every passenger: windows are chained into groups of
+// overlapping windows, and a trip only boards within one group
+int min_direction_trips(std::vector<std::pair<int, int>> windows, int seats) {
+    if (windows.empty() || seats <= 0)
+        return 0;
+    std::sort(windows.begin(), windows.end());
+    int trips = 0;
+    int group_size = 0;
+    int group_end = windows.front().second;
+    for (const auto& window : windows) {
+        if (window.first > group_end) {
+            trips += (group_size + seats - 1) / seats;
+            group_size = 0;
+        }
+        group_end = group_size == 0 ? window.second : std::max(group_end, window.second);
+        ++group_size;
+    }
+    return trips + (group_size + seats - 1) / seats;
+}
+
+} // namespace
+
+PresolveBounds presolve_bounds(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands) {
+    PresolveBounds bounds;
+    int tau = cfg.trip_duration;
+
+    // A fresh shuttle in the slot model must go out and come back
+    bool forced_round_trip = cfg.model_type == "slots";
+    int max_seats = 0;
+    long total_seats = 0;
+    for (int q = 0; q < cfg.num_shuttles; ++q) {
+        const ShuttleType& type = shuttle_type(cfg, q);
+        int rounds = max_trips(cfg, q) / 2;
+        // The outbound leg must leave trip_distance in the battery for the return
+        if (type.battery_capacity < 2 * cfg.trip_distance)
+            rounds = 0;
+        bounds.max_round_trips.push_back(rounds);
+        if (rounds == 0) {
+            if (forced_round_trip && bounds.feasible) {
+                bounds.feasible = false;
+                bounds.reason = "shuttle " + std::to_string(q) + " (" + type.name + ") cannot make its first round trip";
+            }
+            continue;
+        }
+        bounds.slot_capacity += type.seat_capacity;
+        max_seats = std::max(max_seats, type.seat_capacity);
+        total_seats += long(type.seat_capacity) * rounds;
+    }
+    if (!bounds.feasible)
+        return bounds;
+
+    // Pickup windows clipped to the departures a trip in each direction can have
+    int lo[2] = {cfg.start_time, cfg.start_time + tau};
+    int hi[2] = {cfg.end_time - 2 * tau, cfg.end_time - tau};
+    std::vector<std::pair<int, int>> windows[2];
+    std::map<int, int> per_slot[2];
+    for (const auto& req : demands) {
+        int dir = req.direction == Direction::Outbound ? 0 : 1;
+        int slot = static_cast<int>(req.time);
+        ++bounds.requests[dir];
+        ++per_slot[dir][slot];
+        int earliest = std::max(slot, lo[dir]);
+        int latest = std::min(slot + cfg.max_wait, hi[dir]);
+        if (earliest > latest)
+            ++bounds.out_of_window;
+        else
+            windows[dir].push_back({earliest, latest});
+    }
+
+    int unmet_in_window[2];
+    int trips[2];
+    for (int dir = 0; dir < 2; ++dir) {
+        for (const auto& slot : per_slot[dir]) {
+            bounds.peak_demand[dir] = std::max(bounds.peak_demand[dir], slot.second);
+            if (slot.second > bounds.slot_capacity)
+                ++bounds.overloaded_slots[dir];
+        }
+        long served = max_boardable(windows[dir], lo[dir], hi[dir], bounds.slot_capacity);
+        bounds.max_served[dir] = int(std::min(served, total_seats));
+        unmet_in_window[dir] = int(windows[dir].size()) - bounds.max_served[dir];
+        trips[dir] = min_direction_trips(windows[dir], max_seats);
+    }
+    bounds.min_unmet = bounds.out_of_window + unmet_in_window[0] + unmet_in_window[1];
+
+    // Each unmet passenger saves at most one trip, far less than its penalty,
+    // so the bound is lowest with exactly min_unmet passengers left behind,
+    // that is with max_served boarded in each direction. Every shuttle ends
+    // at the hub: as many returns as outbounds.
+    int rounds = forced_round_trip ? cfg.num_shuttles : 0;
+    for (int dir = 0; dir < 2 && max_seats > 0; ++dir)
+        rounds = std::max({rounds, trips[dir] - unmet_in_window[dir],
+                           (bounds.max_served[dir] + max_seats - 1) / max_seats});
+    bounds.min_trips = 2 * rounds;
+    bounds.objective = gamma * bounds.min_unmet + delta * bounds.min_trips;
+    return bounds;
+}
+
+void print_presolve_report(const PresolveBounds& bounds, std::ostream& out) {
+    out << "Presolve bounds" << std::endl;
+    if (!bounds.feasible) {
+        out << "  infeasible: " << bounds.reason << std::endl;
+        return;
+    }
+    if (!bounds.max_round_trips.empty()) {
+        auto range = std::minmax_element(bounds.max_round_trips.begin(), bounds.max_round_trips.end());
+        out << "  round trips per shuttle: at most " << *range.first;
+        if (*range.second != *range.first)
+            out << " to " << *range.second;
+        out << std::endl;
+    }
+    out << "  seats per departure slot: " << bounds.slot_capacity << std::endl;
+    const char* names[2] = {"outbound", "return"};
+    for (int dir = 0; dir < 2; ++dir)
+        out << "  " << names[dir] << ": " << bounds.requests[dir] << " requests, peak slot "
+            << bounds.peak_demand[dir] << " (" << bounds.overloaded_slots[dir] << " slots over capacity), at most "
+            << bounds.max_served[dir] << " boardable" << std::endl;
+    if (bounds.out_of_window > 0)
+        out << "  outside the horizon: " << bounds.out_of_window << " requests" << std::endl;
+    out << "  unmet >= " << bounds.min_unmet << ", trips >= " << bounds.min_trips
+        << ", objective >= " << bounds.objective << std::endl;
+}
+
+double schedule_objective(const Schedule& schedule, const std::vector<DemandRequest>& demands) {
+    double objective = 0;
+    for (const auto& tasks : schedule.shuttles)
+        for (const auto& t : tasks)
+            if (t.mode == TaskMode::OUT || t.mode == TaskMode::RET)
+                objective += delta;
+    for (size_t d = 0; d < demands.size(); ++d) {
+        auto served = schedule.served_by[d];
+        if (served.first < 0)
+            objective += gamma;
+        else
+            objective += alpha * (schedule.shuttles[served.first][served.second].start - static_cast<int>(demands[d].time));
+    }
+    return objective;
+}
+
+std::string schedule_violation(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                               const Schedule& schedule, const std::vector<ShuttleState>& states) {
+    std::vector<ShuttleState> shuttle_states = states.empty() ? initial_states(cfg) : states;
+    if (int(schedule.shuttles.size()) != cfg.num_shuttles)
+        return "schedule has " + std::to_string(schedule.shuttles.size()) + " shuttles";
+
+    for (int q = 0; q < cfg.num_shuttles; ++q) {
+        const auto& tasks = schedule.shuttles[q];
+        const ShuttleType& type = shuttle_type(cfg, q);
+        const ShuttleState& state = shuttle_states[q];
+        std::string shuttle = "shuttle " + std::to_string(q) + ": ";
+        if (tasks.empty() || tasks.back().mode != TaskMode::END)
+            return shuttle + "not closed by END";
+        if (int(tasks.size()) > cfg.max_tasks)
+            return shuttle + "more than max_tasks tasks";
+
+        int soc = state.soc;
+        int t = std::max(state.available_from, cfg.start_time);
+        for (size_t k = 0; k < tasks.size(); ++k) {
+            const ScheduledTask& task = tasks[k];
+            std::string at = shuttle + "task " + std::to_string(k) + " (" + task_mode_name(task.mode) + "): ";
+            bool allowed = k == 0 ? state.allows_first(task.mode) : can_follow(tasks[k - 1].mode, task.mode);
+            if (!allowed || (task.mode == TaskMode::END && k + 1 != tasks.size()))
+                return at + "transition not allowed";
+            if (task.start < t || task.end > cfg.end_time)
+                return at + "overlaps the previous task or leaves the horizon";
+
+            int length = task.end - task.start;
+            int tau = cfg.trip_duration;
+            switch (task.mode) {
+                case TaskMode::OUT:
+                case TaskMode::RET:
+                    if (length != tau)
+                        return at + "wrong length";
+                    // An OUT keeps the energy for its RET
+                    soc -= cfg.trip_distance;
+                    if (soc < (task.mode == TaskMode::OUT ? cfg.trip_distance : 0))
+                        return at + "battery too low";
+                    break;
+                case TaskMode::CRGp:
+                case TaskMode::CRGf: {
+                    int base = task.mode == TaskMode::CRGp ? 2 * tau : tau;
+                    if (length < base || (cfg.charge_curve.empty() ? length != base : length > cfg.max_charge))
+                        return at + "wrong length";
+                    if (task.mode == TaskMode::CRGp && soc > type.soc_threshold)
+                        return at + "battery above the partial charge threshold";
+                    soc += charge_gain(task.mode, soc, length, cfg, q);
+                    if (soc > type.battery_capacity)
+                        return at + "battery over capacity";
+                    break;
+                }
+                case TaskMode::END:
+                    if (task.start != t || task.end != cfg.end_time)
+                        return at + "does not idle from the last task to the end of the horizon";
+                    break;
+            }
+            t = task.end;
+        }
+    }
+
+    std::map<std::pair<int, int>, int> boarded;
+    for (size_t d = 0; d < demands.size() && d < schedule.served_by.size(); ++d) {
+        auto served = schedule.served_by[d];
+        if (served.first < 0)
+            continue;
+        std::string request = "request " + std::to_string(demands[d].req_id) + ": ";
+        if (served.first >= cfg.num_shuttles || served.second < 0 ||
+            served.second >= int(schedule.shuttles[served.first].size()))
+            return request + "boards a task that does not exist";
+        const ScheduledTask& task = schedule.shuttles[served.first][served.second];
+        int td = static_cast<int>(demands[d].time);
+        TaskMode mode = demands[d].direction == Direction::Outbound ? TaskMode::OUT : TaskMode::RET;
+        if (task.mode != mode || task.start < td || task.start > td + cfg.max_wait)
+            return request + "boards outside its window";
+        if (++boarded[served] > shuttle_type(cfg, served.first).seat_capacity)
+            return request + "boards a full trip";
+    }
+    return "";
+}
@@ -0,0 +1,120 @@
+#include "profile.hpp"
+
+#include <sys/resource.h>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "json_writer.hpp"
+
+double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);   // bytes
+#else
+    return usage.ru_maxrss / 1024.0;              // kB
+#endif
+}
+
+Profiler::Profiler() : t0_(std::chrono::steady_clock::now()) {}
+
+double Profiler::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0_).count();
+}
+
+size_t Profiler::begin(const std::string& name) {
+    PhaseRecord record;
+    record.name = name;
+    record.depth = depth_++;
+    record.start = elapsed();
+    record.seconds = 0;
+    record.peak_rss_mb = 0;
+    phases_.push_back(record);
+    return phases_.size() - 1;
+}
+
+void Profiler::end(size_t phase) {
+    PhaseRecord& record = phases_[phase];
+    record.seconds = elapsed() - record.start;
+    record.peak_rss_mb = peak_rss_mb();
+    --depth_;
+}
+
+void Profiler::set_size(size_t phase, long constraints, long variables) {
+    phases_[phase].constraints = constraints;
+    phases_[phase].variables = variables;
+}
+
+void Profiler::add_trace_point(bool has_objective, double objective, double bound) {
+    trace_.push_back({elapsed(), has_objective, objective, bound});
+}
+
+void Profiler::report(std::ostream& out) const {
+    out << "Phase timings" << std::endl;
+    out << std::left << std::setw(36) << "  phase" << std::right << std::setw(10) << "time (s)"
+        << std::setw(12) << "peak MB" << std::setw(13) << "constraints" << std::setw(11) << "variables" << std::endl;
+    for (const auto& record : phases_) {
+        std::string name = std::string(2 + 2 * record.depth, ' ') + record.name;
+        out << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(10) << record.seconds << std::setprecision(1) << std::setw(12) << record.peak_rss_mb;
+        if (record.constraints >= 0)
+            out << std::setw(13) << record.constraints << std::setw(11) << record.variables;
+        out << std::defaultfloat << std::endl;
+    }
+    if (!trace_.empty())
+        out << "  " << trace_.size() << " trace points, last at " << trace_.back().time << " s" << std::endl;
+}
+
+void Profiler::write_json(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error("Cannot write " + path);
+
+    JsonWriter json(file);
+    json.begin_object();
+    json.key("phases").begin_array();
+    json.set_compact(true);
+    for (const auto& record : phases_) {
+        json.begin_object()
+            .field("name", record.name)
+            .field("depth", record.depth)
+            .field("start", record.start)
+            .field("seconds", record.seconds)
+            .field("peak_rss_mb", record.peak_rss_mb);
+        if (record.constraints >= 0)
+            json.field("constraints", record.constraints).field("variables", record.variables);
+        json.end_object();
+    }
+    json.set_compact(false);
+    json.end_array();
+
+    // The bound is infinite (written as null) until the search proves one
+    json.key("trace").begin_array();
+    json.set_compact(true);
+    for (const auto& point : trace_) {
+        json.begin_object().field("time", point.time).key("objective");
+        if (point.has_objective)
+            json.value(point.objective);
+        else
+            json.null();
+        json.field("bound", point.bound).end_object();
+    }
+    json.set_compact(false);
+    json.end_array();
+    json.end_object();
+}
+
+ScopedPhase::ScopedPhase(Profiler* profiler, const std::string& name) : profiler_(profiler) {
+    if (profiler_) {
+        phase_ = profiler_->begin(name);
+        open_ = true;
+    }
+}
+
+void ScopedPhase::stop() {
+    if (open_) {
+        profiler_->end(phase_);
+        open_ = false;
+    }
+}
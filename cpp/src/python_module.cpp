@@ -0,0 +1,318 @@
+// In-process Python binding of the solver (make python; import shuttle_solver).
+// Demand is read in place from any 1-D buffer (NumPy arrays, pandas
+// .to_numpy()), and the schedule comes back as read-only buffers over the
+// SolutionColumns, which np.asarray wraps without copying. The GIL is released
+// while solving, so sweeps can run instances from several Python threads;
+// calls that find the module's model cache free reuse its skeletons.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <ilcp/cp.h>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "demand.hpp"
+#include "model.hpp"
+#include "solution.hpp"
+#include "solver.hpp"
+
+namespace {
+
+// Numeric 1-D input column, read through the buffer protocol without a copy
+class InputColumn {
+public:
+    InputColumn(PyObject* obj, const char* name) {
+        if (PyObject_GetBuffer(obj, &view_, PyBUF_STRIDES | PyBUF_FORMAT) != 0) {
+            PyErr_Clear();
+            throw std::invalid_argument(std::string(name) + ": expected an array or another buffer");
+        }
+        open_ = true;
+        const char* format = view_.format ? view_.format : "B";
+        if (*format == '@' || *format == '=')
+            ++format;
+        if (view_.ndim != 1 || std::strlen(format) != 1 || !std::strchr("bBhHiIlLqQfd?", *format))
+            throw std::invalid_argument(std::string(name) + ": expected a 1-D numeric array in native byte order");
+        type_ = *format;
+    }
+
+    ~InputColumn() {
+        if (open_)
+            PyBuffer_Release(&view_);
+    }
+
+    InputColumn(const InputColumn&) = delete;
+    InputColumn& operator=(const InputColumn&) = delete;
+
+    Py_ssize_t size() const { return view_.shape[0]; }
+
+    double operator[](Py_ssize_t i) const {
+        const char* p = static_cast<const char*>(view_.buf) + i * view_.strides[0];
+        switch (type_) {
+            case 'b': return load<signed char>(p);
+            case 'B': return load<unsigned char>(p);
+            case 'h': return load<short>(p);
+            case 'H': return load<unsigned short>(p);
+            case 'i': return load<int>(p);
+            case 'I': return load<unsigned int>(p);
+            case 'l': return load<long>(p);
+            case 'L': return load<unsigned long>(p);
+            case 'q': return load<long long>(p);
+            case 'Q': return load<unsigned long long>(p);
+            case 'f': return load<float>(p);
+            case '?': return load<bool>(p);
+            default:  return load<double>(p);
+        }
+    }
+
+private:
+    template <class T>
+    static double load(const char* p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return double(value);
+    }
+
+    Py_buffer view_{};
+    bool open_ = false;
+    char type_ = 'd';
+};
+
+// direction (0 outbound, 1 return), time in model slots, optional req_id
+std::vector<DemandRequest> read_demands(PyObject* direction_obj, PyObject* time_obj, PyObject* req_id_obj) {
+    InputColumn direction(direction_obj, "direction");
+    InputColumn time(time_obj, "time");
+    std::unique_ptr<InputColumn> req_id;
+    if (req_id_obj != Py_None)
+        req_id.reset(new InputColumn(req_id_obj, "req_id"));
+    if (time.size() != direction.size() || (req_id && req_id->size() != direction.size()))
+        throw std::invalid_argument("direction, time and req_id must have the same length");
+
+    std::vector<DemandRequest> demands(size_t(direction.size()));
+    for (Py_ssize_t d = 0; d < direction.size(); ++d) {
+        double dir = direction[d];
+        if (dir != 0 && dir != 1)
+            throw std::invalid_argument("direction must be 0 (outbound) or 1 (return)");
+        demands[d].direction = dir == 0 ? Direction::Outbound : Direction::Return;
+        demands[d].time = time[d];
+        demands[d].req_id = req_id ? int((*req_id)[d]) : int(d);
+    }
+    return demands;
+}
+
+// Read-only 1-D buffer over one of the columns of a solution, keeping them alive
+struct ColumnObject {
+    PyObject_HEAD
+    std::shared_ptr<const SolutionColumns>* owner;
+    void* data;
+    Py_ssize_t size;
+    Py_ssize_t itemsize;
+    const char* format;
+};
+
+PyTypeObject ColumnType = {PyVarObject_HEAD_INIT(nullptr, 0) "shuttle_solver.Column"};
+
+int column_getbuffer(PyObject* obj, Py_buffer* view, int flags) {
+    auto* self = reinterpret_cast<ColumnObject*>(obj);
+    if (flags & PyBUF_WRITABLE) {
+        view->obj = nullptr;
+        PyErr_SetString(PyExc_BufferError, "solution columns are read-only");
+        return -1;
+    }
+    view->obj = obj;
+    Py_INCREF(obj);
+    view->buf = self->data;
+    view->len = self->size * self->itemsize;
+    view->readonly = 1;
+    view->itemsize = self->itemsize;
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(self->format) : nullptr;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &self->size : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self->itemsize : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    return 0;
+}
+
+Py_ssize_t column_length(PyObject* obj) {
+    return reinterpret_cast<ColumnObject*>(obj)->size;
+}
+
+void column_dealloc(PyObject* obj) {
+    delete reinterpret_cast<ColumnObject*>(obj)->owner;
+    Py_TYPE(obj)->tp_free(obj);
+}
+
+PyBufferProcs column_buffer = {column_getbuffer, nullptr};
+PySequenceMethods column_sequence = {column_length};
+
+template <class T> const char* format_of();
+template <> const char* format_of<int32_t>() { return "i"; }
+template <> const char* format_of<uint8_t>() { return "B"; }
+template <> const char* format_of<double>() { return "d"; }
+
+template <class T>
+PyObject* make_column(const std::shared_ptr<const SolutionColumns>& owner, const std::vector<T>& column) {
+    static T empty{};
+    ColumnObject* self = PyObject_New(ColumnObject, &ColumnType);
+    if (!self)
+        return nullptr;
+    self->owner = new std::shared_ptr<const SolutionColumns>(owner);
+    self->data = const_cast<T*>(column.empty() ? &empty : column.data());
+    self->size = Py_ssize_t(column.size());
+    self->itemsize = sizeof(T);
+    self->format = format_of<T>();
+    return reinterpret_cast<PyObject*>(self);
+}
+
+// Stores value under key, taking ownership; false with the Python error set on failure
+bool set_item(PyObject* dict, const char* key, PyObject* value) {
+    if (!value)
+        return false;
+    int status = PyDict_SetItemString(dict, key, value);
+    Py_DECREF(value);
+    return status == 0;
+}
+
+PyObject* optional_float(bool has_value, double value) {
+    if (has_value)
+        return PyFloat_FromDouble(value);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyObject* result_dict(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands, const SolveResult& result) {
+    std::shared_ptr<const SolutionColumns> c =
+        std::make_shared<SolutionColumns>(solution_columns(cfg, demands, result.schedule));
+
+    PyObject* out = PyDict_New();
+    PyObject* tasks = PyDict_New();
+    PyObject* requests = PyDict_New();
+    PyObject* modes = PyTuple_New(NUM_TASK_MODES);
+    bool ok = out && tasks && requests && modes
+           && PyDict_SetItemString(out, "tasks", tasks) == 0
+           && PyDict_SetItemString(out, "requests", requests) == 0
+           && PyDict_SetItemString(out, "modes", modes) == 0;
+    // out owns the containers from here on
+    Py_XDECREF(tasks);
+    Py_XDECREF(requests);
+    Py_XDECREF(modes);
+
+    for (int m = 0; ok && m < NUM_TASK_MODES; ++m) {
+        PyObject* name = PyUnicode_FromString(task_mode_name(ALL_TASK_MODES[m]));
+        ok = name && PyTuple_SetItem(modes, m, name) == 0;
+    }
+    ok = ok && set_item(out, "found", PyBool_FromLong(result.found))
+            && set_item(out, "objective", optional_float(result.has_objective, result.objective))
+            && set_item(out, "bound", optional_float(result.has_bound, result.bound))
+            && set_item(out, "solve_time", PyFloat_FromDouble(result.solve_time))
+            && set_item(tasks, "shuttle", make_column(c, c->shuttle))
+            && set_item(tasks, "slot", make_column(c, c->slot))
+            && set_item(tasks, "start", make_column(c, c->start))
+            && set_item(tasks, "end", make_column(c, c->end))
+            && set_item(tasks, "soc_start", make_column(c, c->soc_start))
+            && set_item(tasks, "soc_end", make_column(c, c->soc_end))
+            && set_item(tasks, "mode", make_column(c, c->mode))
+            && set_item(requests, "req_id", make_column(c, c->req_id))
+            && set_item(requests, "req_time", make_column(c, c->req_time))
+            && set_item(requests, "direction", make_column(c, c->direction))
+            && set_item(requests, "served_shuttle", make_column(c, c->served_shuttle))
+            && set_item(requests, "served_slot", make_column(c, c->served_slot))
+            && set_item(requests, "departure", make_column(c, c->departure));
+    if (!ok) {
+        Py_XDECREF(out);
+        return nullptr;
+    }
+    return out;
+}
+
+// Shared by the calls of the process, one at a time; never destroyed, so that
+// its env is not ended after Concert's own statics at exit
+std::mutex cache_mutex;
+ModelCache& shared_cache() {
+    static ModelCache* cache = new ModelCache();
+    return *cache;
+}
+
+PyObject* solve(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"config", "direction", "time", "req_id", "heuristic_only", "verbose", nullptr};
+    const char* config_path;
+    PyObject* direction;
+    PyObject* time;
+    PyObject* req_id = Py_None;
+    int heuristic_only = 0;
+    int verbose = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sOO|Opp", const_cast<char**>(keywords), &config_path,
+                                     &direction, &time, &req_id, &heuristic_only, &verbose))
+        return nullptr;
+
+    try {
+        ProblemConfig cfg = load_config(config_path);
+        cfg.heuristic_only = cfg.heuristic_only || heuristic_only;
+        std::vector<DemandRequest> demands = read_demands(direction, time, req_id);
+
+        // Nothing below touches Python objects
+        SolveResult result;
+        std::string error;
+        Py_BEGIN_ALLOW_THREADS
+        // A call running alongside another one solves in an env of its own
+        std::unique_lock<std::mutex> lock(cache_mutex, std::try_to_lock);
+        ModelCache* cache = lock ? &shared_cache() : nullptr;
+        IloEnv env = cache ? cache->next_env() : IloEnv();
+        try {
+            result = solve_problem(env, cfg, demands, verbose ? std::cerr : env.getNullStream(), nullptr, cache);
+        } catch (IloException& e) {
+            std::ostringstream msg;
+            msg << "Concert exception: " << e;
+            error = msg.str();
+        } catch (std::exception& e) {
+            error = e.what();
+        }
+        if (!cache)
+            env.end();
+        Py_END_ALLOW_THREADS
+        if (!error.empty()) {
+            PyErr_SetString(PyExc_RuntimeError, error.c_str());
+            return nullptr;
+        }
+        return result_dict(cfg, demands, result);
+    } catch (std::invalid_argument& e) {
+        PyErr_SetString(PyExc_ValueError, e.what());
+    } catch (std::exception& e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+    }
+    return nullptr;
+}
+
+PyMethodDef methods[] = {
+    {"solve", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(solve)), METH_VARARGS | METH_KEYWORDS,
+     "solve(config, direction, time, req_id=None, heuristic_only=False, verbose=False)\n\n"
+     "Solves one instance with the pipeline configured in the config.yaml at `config`.\n"
+     "direction (0 outbound, 1 return), time (model slots) and req_id are 1-D arrays\n"
+     "with one entry per request. Returns a dict with found, objective, bound,\n"
+     "solve_time, the task and request columns of the schedule as buffers\n"
+     "(tasks, requests) and the mode names indexed by tasks['mode'] (modes).\n"
+     "Unmet requests have served_shuttle, served_slot and departure -1."},
+    {nullptr, nullptr, 0, nullptr}};
+
+PyModuleDef module = {PyModuleDef_HEAD_INIT, "shuttle_solver", "Shuttle scheduling solver, in process.", -1, methods};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_shuttle_solver() {
+    ColumnType.tp_basicsize = sizeof(ColumnObject);
+    ColumnType.tp_flags = Py_TPFLAGS_DEFAULT;
+    ColumnType.tp_doc = "Read-only column of a solution; wrap with numpy.asarray.";
+    ColumnType.tp_dealloc = column_dealloc;
+    ColumnType.tp_as_buffer = &column_buffer;
+    ColumnType.tp_as_sequence = &column_sequence;
+    if (PyType_Ready(&ColumnType) < 0)
+        return nullptr;
+    return PyModule_Create(&module);
+}
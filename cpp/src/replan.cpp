@@ -0,0 +1,458 @@
+#include "replan.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "heuristic.hpp"
+#include "solution.hpp"
+#include "solver.hpp"
+
+namespace {
+
+// Same weights as the CP objective
+constexpr double alpha = 100;
+constexpr double gamma = 1000000;
+constexpr double delta = 1;
+
+} // namespace
+
+ReplanSession::ReplanSession(const ProblemConfig& cfg, std::vector<DemandRequest> demands, std::ostream& log)
+    : cfg_(cfg), demands_(std::move(demands)), plan_(cfg.num_shuttles),
+      in_service_(cfg.num_shuttles, true), now_(cfg.start_time), log_(log),
+      solved_(cfg.num_shuttles), frozen_(cfg.num_shuttles, 0), retired_(cfg.num_shuttles, -1) {}
+
+ReplanSession::~ReplanSession() {
+    env_.end();
+}
+
+size_t ReplanSession::find_request(int req_id) const {
+    for (size_t d = 0; d < demands_.size(); ++d)
+        if (demands_[d].req_id == req_id)
+            return d;
+    throw std::invalid_argument("Unknown request " + std::to_string(req_id));
+}
+
+size_t ReplanSession::frozen_tasks(int q) const {
+    size_t k = 0;
+    while (k < plan_[q].size() && plan_[q][k].mode != TaskMode::END && plan_[q][k].start < now_)
+        ++k;
+    return k;
+}
+
+bool ReplanSession::picked_up(int req_id) const {
+    auto it = served_.find(req_id);
+    return it != served_.end() && size_t(it->second.second) < frozen_tasks(it->second.first);
+}
+
+void ReplanSession::add_request(const DemandRequest& req) {
+    for (const auto& d : demands_)
+        if (d.req_id == req.req_id)
+            throw std::invalid_argument("Duplicate request " + std::to_string(req.req_id));
+    demands_.push_back(req);
+}
+
+void ReplanSession::remove_request(int req_id) {
+    size_t d = find_request(req_id);
+    if (picked_up(req_id))
+        throw std::invalid_argument("Request " + std::to_string(req_id) + " already picked up");
+    demands_.erase(demands_.begin() + d);
+    served_.erase(req_id);
+}
+
+void ReplanSession::modify_request(const DemandRequest& req) {
+    size_t d = find_request(req.req_id);
+    if (picked_up(req.req_id))
+        throw std::invalid_argument("Request " + std::to_string(req.req_id) + " already picked up");
+    demands_[d] = req;
+    served_.erase(req.req_id);
+}
+
+void ReplanSession::set_unavailable(int shuttle) {
+    if (shuttle < 0 || shuttle >= cfg_.num_shuttles)
+        throw std::invalid_argument("Unknown shuttle " + std::to_string(shuttle));
+    in_service_[shuttle] = false;
+}
+
+void ReplanSession::advance(int now) {
+    if (now < now_)
+        throw std::invalid_argument("Time cannot move backwards");
+    now_ = std::min(now, cfg_.end_time);
+}
+
+Schedule ReplanSession::schedule() const {
+    Schedule schedule;
+    schedule.shuttles = plan_;
+    for (const auto& req : demands_) {
+        auto it = served_.find(req.req_id);
+        schedule.served_by.push_back(it == served_.end() ? std::make_pair(-1, -1) : it->second);
+    }
+    return schedule;
+}
+
+void ReplanSession::build_model_once() {
+    if (built_)
+        return;
+    std::vector<ShuttleState> states = initial_states(cfg_);
+    for (int q = 0; q < cfg_.num_shuttles; ++q)
+        bounds_.push_back(compute_task_bounds(states[q], cfg_.end_time, cfg_.trip_duration, cfg_.max_tasks));
+
+    // Slot model whatever the config asks for; the demand layer is added request by request
+    ProblemConfig model_cfg = cfg_;
+    model_cfg.model_type = "slots";
+    model_cfg.time_limit = cfg_.replan_time_limit;
+    sm_ = build_model(env_, model_cfg, {}, states);
+    cp_ = IloCP(sm_.model);
+    configure_solver(cp_, sm_, model_cfg);
+    cp_.setOut(log_);
+    incumbent_ = IloSolution(env_);
+    incumbent_.add(sm_.all_intervals);
+    built_ = true;
+}
+
+void ReplanSession::freeze_started_tasks() {
+    for (int q = 0; q < cfg_.num_shuttles; ++q) {
+        const std::vector<ScheduledTask>& tasks = solved_[q];
+        size_t count = frozen_[q];
+        while (count < tasks.size() && tasks[count].mode != TaskMode::END && tasks[count].start < now_)
+            ++count;
+
+        // Fix each newly started task, and who boarded it, to the last plan
+        for (size_t k = frozen_[q]; k < count; ++k) {
+            const ScheduledTask& t = tasks[k];
+            for (TaskMode mode : ALL_TASK_MODES)
+                if (mode != t.mode)
+                    sm_.tasks(q, int(k), mode).setAbsent();
+            IloIntervalVar& var = sm_.tasks(q, int(k), t.mode);
+            var.setPresent();
+            var.setStartMin(t.start);
+            var.setStartMax(t.start);
+            var.setEndMin(t.end);
+            var.setEndMax(t.end);
+            for (Direction direction : {Direction::Outbound, Direction::Return}) {
+                auto it = seat_limits_.find(SeatKey(q, int(k), direction));
+                if (it == seat_limits_.end())
+                    continue;
+                for (auto& rider : it->second.riders) {
+                    auto served = served_.find(rider.first);
+                    IloInt boarded = served != served_.end() && served->second == std::make_pair(q, int(k));
+                    rider.second.setBounds(boarded, boarded);
+                }
+            }
+        }
+        frozen_[q] = count;
+
+        // The next task cannot start in the past; an END may, right after the last task
+        if (int(count) < cfg_.max_tasks) {
+            int k = int(count);
+            sm_.tasks(q, k, TaskMode::OUT).setStartMin(std::max(now_, bounds_[q].out_earliest[k]));
+            sm_.tasks(q, k, TaskMode::RET).setStartMin(std::max(now_, bounds_[q].ret_earliest[k]));
+            sm_.tasks(q, k, TaskMode::CRGp).setStartMin(now_);
+            sm_.tasks(q, k, TaskMode::CRGf).setStartMin(now_);
+        }
+    }
+}
+
+void ReplanSession::retire_shuttles() {
+    for (int q = 0; q < cfg_.num_shuttles; ++q) {
+        if (in_service_[q] || retired_[q] >= 0)
+            continue;
+        // It keeps the tasks it has started; its later trips board nobody, and
+        // only the return that gets it back to base is published
+        retired_[q] = int(frozen_[q]);
+        for (auto& entry : seat_limits_)
+            if (std::get<0>(entry.first) == q && std::get<1>(entry.first) >= retired_[q])
+                for (auto& rider : entry.second.riders)
+                    rider.second.setUB(0);
+    }
+}
+
+void ReplanSession::add_request_model(const DemandRequest& req) {
+    RequestModel r;
+    r.req = req;
+    r.assign = IloIntVarArray(env_);
+    r.constraints = IloConstraintArray(env_);
+    IloModel& model = sm_.model;
+    int earliest = static_cast<int>(req.time);
+    int latest = earliest + cfg_.max_wait;
+    std::string suffix = "_to_request" + std::to_string(req.req_id);
+
+    // Arcs to the trips still open that can start inside the window
+    IloExpr boarded(env_);
+    IloExpr wait(env_);
+    std::vector<SeatKey> touched;
+    for (int q = 0; q < cfg_.num_shuttles; ++q) {
+        if (!in_service_[q])
+            continue;
+        for (int k = int(frozen_[q]); k < cfg_.max_tasks; ++k) {
+            if (!bounds_[q].allows(req.direction, k, std::max(earliest, now_), latest))
+                continue;
+            const IloIntervalVar& task = sm_.tasks(q, k, trip_mode(req.direction));
+            IloBoolVar a(env_, ("assign_shuttle" + std::to_string(q) + "_task" + std::to_string(k) + suffix).c_str());
+            r.trips.push_back({q, k});
+            r.assign.add(a);
+            r.constraints.add(model.add(IloIfThen(env_, a >= 1, IloPresenceOf(env_, task) == 1)));
+            r.constraints.add(model.add(IloIfThen(env_, a >= 1, IloStartOf(task) >= earliest)));
+            r.constraints.add(model.add(IloIfThen(env_, a >= 1, IloStartOf(task) <= latest)));
+            boarded += a;
+            wait += a * (IloStartOf(task) - earliest);
+
+            SeatKey key(q, k, req.direction);
+            seat_limits_[key].riders[req.req_id] = a;
+            touched.push_back(key);
+        }
+    }
+    r.unmet = IloIntVar(env_, 0, 1, ("u" + suffix).c_str());
+    r.wait = IloIntVar(env_, 0, cfg_.end_time - cfg_.start_time, ("w" + suffix).c_str());
+    r.constraints.add(model.add(boarded + r.unmet == 1));
+    r.constraints.add(model.add(r.wait == wait));
+    boarded.end();
+    wait.end();
+
+    requests_[req.req_id] = r;
+    for (const SeatKey& key : touched)
+        update_seat_limit(key);
+}
+
+// Ends the request's variables: the objective must no longer refer to them
+void ReplanSession::remove_request_model(int req_id) {
+    auto it = requests_.find(req_id);
+    RequestModel& r = it->second;
+    for (IloInt c = 0; c < r.constraints.getSize(); ++c)
+        sm_.model.remove(r.constraints[c]);
+    for (const auto& trip : r.trips) {
+        SeatKey key(trip.first, trip.second, r.req.direction);
+        seat_limits_[key].riders.erase(req_id);
+        update_seat_limit(key);
+    }
+    if (r.in_incumbent) {
+        incumbent_.remove(r.assign);
+        incumbent_.remove(r.unmet);
+        incumbent_.remove(r.wait);
+    }
+    r.constraints.endElements();
+    r.constraints.end();
+    r.assign.endElements();
+    r.assign.end();
+    r.unmet.end();
+    r.wait.end();
+    requests_.erase(it);
+}
+
+void ReplanSession::update_seat_limit(const SeatKey& key) {
+    SeatLimit& seats = seat_limits_[key];
+    if (seats.limit.getImpl()) {
+        sm_.model.remove(seats.limit);
+        seats.limit.end();
+        seats.limit = IloConstraint();
+    }
+    if (seats.riders.empty()) {
+        seat_limits_.erase(key);
+        return;
+    }
+    IloExpr pax(env_);
+    for (const auto& rider : seats.riders)
+        pax += rider.second;
+    seats.limit = sm_.model.add(pax <= shuttle_type(cfg_, std::get<0>(key)).seat_capacity);
+    pax.end();
+}
+
+void ReplanSession::sync_requests() {
+    std::set<int> live;
+    std::vector<int> stale;
+    for (const auto& req : demands_) {
+        live.insert(req.req_id);
+        auto it = requests_.find(req.req_id);
+        if (it != requests_.end() && (it->second.req.direction != req.direction || it->second.req.time != req.time))
+            stale.push_back(req.req_id);
+    }
+    for (const auto& entry : requests_)
+        if (!live.count(entry.first))
+            stale.push_back(entry.first);
+    // The objective refers to the unmet and wait variables of every request:
+    // take it out before any of them is ended; update_objective() adds it back
+    if (!stale.empty() && sm_.objective.getImpl()) {
+        sm_.model.remove(sm_.objective);
+        sm_.objective.end();
+        sm_.objective = IloObjective();
+    }
+    for (int req_id : stale)
+        remove_request_model(req_id);
+    for (const auto& req : demands_)
+        if (!requests_.count(req.req_id))
+            add_request_model(req);
+}
+
+void ReplanSession::update_objective() {
+    IloExpr obj(env_);
+    for (const IloBoolVar& z : sm_.trip_flags)
+        obj += delta * z;
+    for (const auto& entry : requests_)
+        obj += alpha * entry.second.wait + gamma * entry.second.unmet;
+    if (sm_.objective.getImpl()) {
+        sm_.model.remove(sm_.objective);
+        sm_.objective.end();
+    }
+    sm_.objective = IloMinimize(env_, obj);
+    sm_.model.add(sm_.objective);
+    obj.end();
+}
+
+void ReplanSession::read_solution() {
+    solved_ = extract_schedule(cp_, sm_, 0).shuttles;
+    served_.clear();
+    for (auto& entry : requests_) {
+        RequestModel& r = entry.second;
+        for (size_t j = 0; j < r.trips.size(); ++j)
+            if (cp_.getValue(r.assign[IloInt(j)]) >= 1)
+                served_[entry.first] = r.trips[j];
+        if (!r.in_incumbent) {
+            incumbent_.add(r.assign);
+            incumbent_.add(r.unmet);
+            incumbent_.add(r.wait);
+            r.in_incumbent = true;
+        }
+    }
+    incumbent_.store(cp_);
+    has_incumbent_ = true;
+
+    // An out-of-service shuttle keeps the tasks it had started and, if it was
+    // away, the return that brings it back to base; then it idles. Trips the
+    // model keeps for it after that board nobody and are not published.
+    plan_ = solved_;
+    for (int q = 0; q < cfg_.num_shuttles; ++q) {
+        if (retired_[q] < 0)
+            continue;
+        std::vector<ScheduledTask>& tasks = plan_[q];
+        size_t keep = std::min(tasks.size(), size_t(retired_[q]));
+        if (keep > 0 && keep < tasks.size() && tasks[keep - 1].mode == TaskMode::OUT)
+            ++keep;
+        tasks.resize(keep);
+        if (tasks.empty() || can_follow(tasks.back().mode, TaskMode::END))
+            pad_with_end(tasks, tasks.empty() ? cfg_.start_time : tasks.back().end, cfg_);
+    }
+}
+
+bool ReplanSession::replan() {
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Bring the model up to date: the clock, the fleet, then the demand deltas
+    build_model_once();
+    freeze_started_tasks();
+    retire_shuttles();
+    sync_requests();
+    update_objective();
+
+    if (has_incumbent_) {
+        cp_.setStartingPoint(incumbent_);
+    } else {
+        // First solve: the greedy schedule over the requests still open
+        std::vector<ShuttleState> states = initial_states(cfg_);
+        for (auto& state : states)
+            state.available_from = std::max(state.available_from, now_);
+        Schedule greedy = greedy_schedule(cfg_, demands_, states);
+        IloSolution start = make_starting_point(env_, sm_, greedy.shuttles);
+        for (size_t d = 0; d < demands_.size(); ++d) {
+            const RequestModel& r = requests_.at(demands_[d].req_id);
+            for (size_t j = 0; j < r.trips.size(); ++j)
+                if (r.trips[j] == greedy.served_by[d]) {
+                    start.add(r.assign[IloInt(j)]);
+                    start.setValue(r.assign[IloInt(j)], 1);
+                }
+        }
+        cp_.setStartingPoint(start);
+    }
+
+    bool found = cp_.solve();
+    if (found) {
+        read_solution();
+        size_t open = 0;
+        for (const auto& req : demands_)
+            open += !picked_up(req.req_id) && int(req.time) + cfg_.max_wait >= now_;
+        log_ << "Re-planned " << open << " open requests on "
+             << std::count(in_service_.begin(), in_service_.end(), true) << " shuttles from slot " << now_
+             << ", objective " << cp_.getObjValue() << "." << std::endl;
+    } else {
+        log_ << "No solution found; keeping the previous plan." << std::endl;
+    }
+
+    log_ << "Re-plan took " << std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count()
+         << " s." << std::endl;
+    return found;
+}
+
+namespace {
+
+DemandRequest parse_request(std::istringstream& args) {
+    DemandRequest req;
+    std::string direction;
+    if (!(args >> req.req_id >> direction >> req.time))
+        throw std::invalid_argument("expected <req_id> <OUTBOUND|RETURN> <slot>");
+    req.direction = parse_direction(direction);
+    return req;
+}
+
+} // namespace
+
+void run_daemon(ReplanSession& session, std::istream& in, std::ostream& out) {
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream args(line);
+        std::string command;
+        if (!(args >> command) || command[0] == '#')
+            continue;
+
+        try {
+            if (command == "add") {
+                session.add_request(parse_request(args));
+            } else if (command == "modify") {
+                session.modify_request(parse_request(args));
+            } else if (command == "remove") {
+                int req_id;
+                if (!(args >> req_id))
+                    throw std::invalid_argument("expected <req_id>");
+                session.remove_request(req_id);
+            } else if (command == "unavailable") {
+                int shuttle;
+                if (!(args >> shuttle))
+                    throw std::invalid_argument("expected <shuttle>");
+                session.set_unavailable(shuttle);
+            } else if (command == "now") {
+                int now;
+                if (!(args >> now))
+                    throw std::invalid_argument("expected <slot>");
+                session.advance(now);
+            } else if (command == "solve") {
+                auto t0 = std::chrono::steady_clock::now();
+                bool found = session.replan();
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                Schedule schedule = session.schedule();
+                size_t served = std::count_if(schedule.served_by.begin(), schedule.served_by.end(),
+                                              [](const std::pair<int, int>& s) { return s.first >= 0; });
+                out << (found ? "ok" : "ok unchanged") << " served " << served << "/" << schedule.served_by.size()
+                    << " in " << seconds << " s" << std::endl;
+                continue;
+            } else if (command == "schedule") {
+                print_schedule(out, session.config(), session.schedule());
+            } else if (command == "write") {
+                std::string path;
+                if (!(args >> path))
+                    throw std::invalid_argument("expected <path>");
+                write_solution(path, session.config(), session.demands(), session.schedule());
+            } else if (command == "quit") {
+                out << "ok" << std::endl;
+                return;
+            } else {
+                throw std::invalid_argument("unknown command " + command);
+            }
+            out << "ok" << std::endl;
+        } catch (IloException& e) {
+            out << "error " << e.getMessage() << std::endl;
+        } catch (std::exception& e) {
+            out << "error " << e.what() << std::endl;
+        }
+    }
+}
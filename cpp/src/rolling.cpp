@@ -0,0 +1,101 @@
+#include "rolling.hpp"
+
+#include <ilcp/cp.h>
+#include <algorithm>
+
+#include "model.hpp"
+#include "solver.hpp"
+
+Schedule solve_rolling_horizon(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                               std::ostream& log) {
+    Schedule merged;
+    merged.shuttles.resize(cfg.num_shuttles);
+    merged.served_by.assign(demands.size(), {-1, -1});
+
+    std::vector<ShuttleState> states = initial_states(cfg);
+    std::vector<std::vector<ScheduledTask>> hint(cfg.num_shuttles);
+
+    int window_start = cfg.start_time;
+    for (int w = 0; window_start < cfg.end_time; ++w) {
+        int window_end = std::min(window_start + cfg.window_length, cfg.end_time);
+        // Absorb a tail too short for a round trip into this window
+        if (cfg.end_time - window_end < 2 * cfg.trip_duration)
+            window_end = cfg.end_time;
+        bool last = window_end == cfg.end_time;
+        int commit_end = last ? window_end : window_end - cfg.window_overlap;
+
+        // Requests not served yet whose pickup window is open inside this window
+        std::vector<DemandRequest> window_demands;
+        std::vector<size_t> global_id;
+        for (size_t d = 0; d < demands.size(); ++d) {
+            int td = static_cast<int>(demands[d].time);
+            if (merged.served_by[d].first >= 0 || td + cfg.max_wait < window_start || td >= window_end)
+                continue;
+            window_demands.push_back(demands[d]);
+            global_id.push_back(d);
+        }
+
+        ProblemConfig window_cfg = with_horizon(cfg, window_start, window_end);
+        window_cfg.time_limit = cfg.window_time_limit;
+        log << "Window " << w << " [" << window_start << ", " << window_end << "), committing up to "
+            << commit_end << ": " << window_demands.size() << " requests." << std::endl;
+
+        IloEnv env;
+        try {
+            ShuttleModel sm = build_model(env, window_cfg, window_demands, states);
+            IloCP cp(sm.model);
+            configure_solver(cp, sm, window_cfg);
+            cp.setOut(log);
+            cp.setStartingPoint(make_starting_point(env, sm, hint));
+
+            if (cp.solve()) {
+                log << "Window " << w << " objective: " << cp.getObjValue() << std::endl;
+                Schedule window = extract_schedule(cp, sm, window_demands.size());
+
+                // Commit tasks starting before the next window; the rest becomes its hint
+                std::vector<std::vector<int>> merged_pos(cfg.num_shuttles);
+                for (int q = 0; q < cfg.num_shuttles; ++q) {
+                    hint[q].clear();
+                    merged_pos[q].assign(window.shuttles[q].size(), -1);
+                    for (size_t k = 0; k < window.shuttles[q].size(); ++k) {
+                        ScheduledTask t = window.shuttles[q][k];
+                        bool committed = last || (t.mode != TaskMode::END && t.start < commit_end);
+                        if (!committed) {
+                            if (t.mode != TaskMode::END)
+                                hint[q].push_back(t);
+                            continue;
+                        }
+                        merged_pos[q][k] = int(merged.shuttles[q].size());
+                        t.slot = merged_pos[q][k];
+                        merged.shuttles[q].push_back(t);
+
+                        if (t.mode != TaskMode::END) {
+                            states[q].available_from = t.end;
+                            states[q].soc += task_soc_delta(t, states[q].soc, cfg, q);
+                            states[q].has_prev = true;
+                            states[q].prev_mode = t.mode;
+                        }
+                    }
+                }
+
+                for (size_t d = 0; d < window_demands.size(); ++d) {
+                    auto served = window.served_by[d];
+                    if (served.first >= 0 && merged_pos[served.first][served.second] >= 0)
+                        merged.served_by[global_id[d]] = {served.first, merged_pos[served.first][served.second]};
+                }
+            } else {
+                // Nothing is committed: shuttles keep their state into the next window
+                log << "No solution found for window " << w << "." << std::endl;
+                for (auto& h : hint)
+                    h.clear();
+            }
+        } catch (...) {
+            env.end();
+            throw;
+        }
+        env.end();
+
+        window_start = commit_end;
+    }
+    return merged;
+}
@@ -0,0 +1,79 @@
+#include "schedule.hpp"
+
+#include <algorithm>
+
+const char* task_mode_name(TaskMode mode) {
+    switch (mode) {
+        case TaskMode::OUT:  return "OUT";
+        case TaskMode::RET:  return "RET";
+        case TaskMode::CRGp: return "CRGp";
+        case TaskMode::CRGf: return "CRGf";
+        case TaskMode::END:  return "END";
+    }
+    return "";
+}
+
+bool can_follow(TaskMode prev, TaskMode next) {
+    switch (prev) {
+        case TaskMode::OUT:  return next == TaskMode::RET;
+        case TaskMode::RET:  return next != TaskMode::RET;
+        case TaskMode::CRGp: return next == TaskMode::OUT;
+        case TaskMode::CRGf: return next == TaskMode::OUT || next == TaskMode::CRGf;
+        case TaskMode::END:  return next == TaskMode::END;
+    }
+    return false;
+}
+
+int soc_delta(TaskMode mode, const ProblemConfig& cfg, int shuttle) {
+    switch (mode) {
+        case TaskMode::OUT:
+        case TaskMode::RET:  return -cfg.trip_distance;
+        case TaskMode::CRGp: return shuttle_type(cfg, shuttle).battery_capacity / 2;
+        case TaskMode::CRGf: return shuttle_type(cfg, shuttle).battery_capacity / 6;
+        case TaskMode::END:  return 0;
+    }
+    return 0;
+}
+
+int charge_gain(TaskMode mode, int soc, int length, const ProblemConfig& cfg, int shuttle) {
+    const ShuttleType& type = shuttle_type(cfg, shuttle);
+    if (!type.charging || (mode != TaskMode::CRGp && mode != TaskMode::CRGf))
+        return soc_delta(mode, cfg, shuttle);
+    const ChargeTable& table = *type.charging;
+    return table.gain(std::max(0, std::min(soc, table.capacity())), std::max(0, std::min(length, table.max_slots())));
+}
+
+int task_soc_delta(const ScheduledTask& t, int soc, const ProblemConfig& cfg, int shuttle) {
+    return charge_gain(t.mode, soc, t.end - t.start, cfg, shuttle);
+}
+
+std::vector<ShuttleState> initial_states(const ProblemConfig& cfg) {
+    std::vector<ShuttleState> states(cfg.num_shuttles);
+    for (int q = 0; q < cfg.num_shuttles; ++q) {
+        states[q].available_from = cfg.start_time;
+        states[q].soc = shuttle_type(cfg, q).battery_capacity;
+    }
+    return states;
+}
+
+void pad_with_end(std::vector<ScheduledTask>& tasks, int from, const ProblemConfig& cfg) {
+    if (int(tasks.size()) < cfg.max_tasks)
+        tasks.push_back({TaskMode::END, int(tasks.size()), std::min(from, cfg.end_time), cfg.end_time});
+}
+
+std::vector<std::pair<int, int>> soc_timeline(const std::vector<ScheduledTask>& tasks, const ProblemConfig& cfg,
+                                              int shuttle, int initial_soc) {
+    std::vector<std::pair<int, int>> timeline = {{cfg.start_time, initial_soc}};
+    int soc = initial_soc;
+    for (const ScheduledTask& t : tasks) {
+        if (t.mode == TaskMode::END)
+            continue;
+        soc += task_soc_delta(t, soc, cfg, shuttle);
+        int time = (t.mode == TaskMode::OUT || t.mode == TaskMode::RET) ? t.start : t.end;
+        if (timeline.back().first == time)
+            timeline.back().second = soc;
+        else
+            timeline.push_back({time, soc});
+    }
+    return timeline;
+}
@@ -0,0 +1,229 @@
+#include "solution.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+#include "json_writer.hpp"
+
+void print_schedule(std::ostream& out, const ProblemConfig& cfg, const Schedule& schedule) {
+    out << "battery_capacity: " << cfg.battery_capacity << std::endl;
+    out << "trip_distance: " << cfg.trip_distance << std::endl;
+    out << "max_recharge: " << cfg.max_recharge << std::endl;
+    out << "min_recharge: " << cfg.min_recharge << std::endl;
+    out << "num_shuttles: " << cfg.num_shuttles << std::endl;
+    out << "seat_capacity: " << cfg.seat_capacity << std::endl;
+    out << "max_tasks: " << cfg.max_tasks << std::endl;
+    out << "trip_duration: " << cfg.trip_duration << std::endl;
+
+    for (int i = 0; i < cfg.num_shuttles; ++i) {
+        int soc = shuttle_type(cfg, i).battery_capacity;
+        for (const ScheduledTask& t : schedule.shuttles[i]) {
+            int delta = task_soc_delta(t, soc, cfg, i);
+            soc += delta;
+            out << "Shuttle " << i
+                << ", Task " << t.slot
+                << ", " << task_mode_name(t.mode);
+            if (t.mode == TaskMode::CRGp || t.mode == TaskMode::CRGf) {
+                out << ", Start = " << t.start
+                    << ", End = " << t.end
+                    << ", Duration = " << t.end - t.start
+                    // Show recharge rates for CRGp and CRGf
+                    << ", Recharge Rate = " << delta
+                    << std::endl;
+            } else {
+                out << ": Start = " << t.start
+                    << ", End = " << t.end
+                    << ", Duration = " << t.end - t.start
+                    << std::endl;
+            }
+        }
+    }
+}
+
+namespace {
+
+// Request indices boarded on each task, in one pass over the assignments
+std::vector<std::vector<std::vector<size_t>>> passengers_by_task(const Schedule& schedule) {
+    std::vector<std::vector<std::vector<size_t>>> passengers(schedule.shuttles.size());
+    for (size_t q = 0; q < schedule.shuttles.size(); ++q)
+        passengers[q].resize(schedule.shuttles[q].size());
+    for (size_t d = 0; d < schedule.served_by.size(); ++d) {
+        auto served = schedule.served_by[d];
+        if (served.first >= 0)
+            passengers[served.first][served.second].push_back(d);
+    }
+    return passengers;
+}
+
+template <class T>
+void write_column(std::ofstream& file, const std::vector<T>& column) {
+    file.write(reinterpret_cast<const char*>(column.data()), std::streamsize(column.size() * sizeof(T)));
+}
+
+} // namespace
+
+void write_solution_json(const std::string& path, const ProblemConfig& cfg,
+                         const std::vector<DemandRequest>& demands, const Schedule& schedule) {
+    std::ofstream solfile(path);
+    if (!solfile)
+        throw std::runtime_error("Cannot write " + path);
+    JsonWriter json(solfile);
+    auto passengers = passengers_by_task(schedule);
+
+    json.begin_object();
+    json.key("parameters").begin_object()
+        .field("time_res", cfg.time_res)
+        .field("start_time", cfg.start_time)
+        .field("end_time", cfg.end_time)
+        .field("battery_capacity", cfg.battery_capacity)
+        .field("trip_distance", cfg.trip_distance)
+        .field("max_recharge", cfg.max_recharge)
+        .field("min_recharge", cfg.min_recharge)
+        .field("num_shuttles", cfg.num_shuttles)
+        .field("seat_capacity", cfg.seat_capacity)
+        .field("max_tasks", cfg.max_tasks)
+        .field("trip_duration", cfg.trip_duration)
+        .end_object();
+
+    json.key("shuttles").begin_array();
+    for (size_t q = 0; q < schedule.shuttles.size(); ++q) {
+        const ShuttleType& type = shuttle_type(cfg, int(q));
+        json.begin_object()
+            .field("id", int(q))
+            .field("type", type.name)
+            .field("seat_capacity", type.seat_capacity)
+            .field("battery_capacity", type.battery_capacity);
+
+        json.key("tasks").begin_array();
+        json.set_compact(true);
+        int soc = type.battery_capacity;
+        for (size_t k = 0; k < schedule.shuttles[q].size(); ++k) {
+            const ScheduledTask& t = schedule.shuttles[q][k];
+            json.begin_object()
+                .field("task", task_mode_name(t.mode))
+                .field("slot", t.slot)
+                .field("start", t.start)
+                .field("end", t.end)
+                .field("duration", t.end - t.start)
+                .field("soc_start", soc);
+            int delta = task_soc_delta(t, soc, cfg, int(q));
+            soc += delta;
+            json.field("soc_end", soc);
+            if (t.mode == TaskMode::CRGp || t.mode == TaskMode::CRGf)
+                json.field("recharge_rate", delta);
+            json.key("passengers").begin_array();
+            for (size_t d : passengers[q][k])
+                json.value(demands[d].req_id);
+            json.end_array();
+            json.end_object();
+        }
+        json.set_compact(false);
+        json.end_array();
+
+        json.key("soc").begin_array();
+        json.set_compact(true);
+        for (const auto& point : soc_timeline(schedule.shuttles[q], cfg, int(q), type.battery_capacity))
+            json.begin_array().value(point.first).value(point.second).end_array();
+        json.set_compact(false);
+        json.end_array();
+
+        json.end_object();
+    }
+    json.end_array();
+
+    json.key("assignments").begin_array();
+    json.set_compact(true);
+    for (size_t d = 0; d < demands.size(); ++d) {
+        int q = schedule.served_by[d].first;
+        if (q < 0)
+            continue;
+        const ScheduledTask& t = schedule.shuttles[q][schedule.served_by[d].second];
+        json.begin_object()
+            .field("demand_id", demands[d].req_id)
+            .field("shuttle", q)
+            .field("task", t.slot)
+            .field("direction", direction_name(demands[d].direction))
+            .field("req_time", demands[d].time)
+            .field("departure_time", t.start)
+            .end_object();
+    }
+    json.set_compact(false);
+    json.end_array();
+
+    json.key("unmet").begin_array();
+    json.set_compact(true);
+    for (size_t d = 0; d < demands.size(); ++d)
+        if (schedule.served_by[d].first < 0)
+            json.value(demands[d].req_id);
+    json.set_compact(false);
+    json.end_array();
+
+    json.end_object();
+}
+
+SolutionColumns solution_columns(const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                                 const Schedule& schedule) {
+    SolutionColumns c;
+
+    // Task table
+    for (size_t q = 0; q < schedule.shuttles.size(); ++q) {
+        int soc = shuttle_type(cfg, int(q)).battery_capacity;
+        for (const ScheduledTask& t : schedule.shuttles[q]) {
+            c.shuttle.push_back(int32_t(q));
+            c.slot.push_back(t.slot);
+            c.start.push_back(t.start);
+            c.end.push_back(t.end);
+            c.soc_start.push_back(soc);
+            soc += task_soc_delta(t, soc, cfg, int(q));
+            c.soc_end.push_back(soc);
+            c.mode.push_back(uint8_t(t.mode));
+        }
+    }
+
+    // Request table
+    for (size_t d = 0; d < demands.size(); ++d) {
+        auto served = schedule.served_by[d];
+        c.req_time.push_back(demands[d].time);
+        c.req_id.push_back(demands[d].req_id);
+        c.direction.push_back(uint8_t(demands[d].direction));
+        const ScheduledTask* t = served.first >= 0 ? &schedule.shuttles[served.first][served.second] : nullptr;
+        c.served_shuttle.push_back(served.first);
+        c.served_slot.push_back(t ? t->slot : -1);
+        c.departure.push_back(t ? t->start : -1);
+    }
+    return c;
+}
+
+void write_solution_binary(const std::string& path, const ProblemConfig& cfg,
+                           const std::vector<DemandRequest>& demands, const Schedule& schedule) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Cannot write " + path);
+
+    SolutionColumns c = solution_columns(cfg, demands, schedule);
+    int32_t params[] = {cfg.num_shuttles, cfg.time_res, cfg.start_time, cfg.end_time,
+                        cfg.battery_capacity, cfg.trip_distance, cfg.seat_capacity, cfg.trip_duration};
+    uint64_t counts[] = {c.mode.size(), c.req_id.size()};
+    file.write(SOLUTION_MAGIC, 4);
+    file.write(reinterpret_cast<const char*>(&SOLUTION_VERSION), sizeof(SOLUTION_VERSION));
+    file.write(reinterpret_cast<const char*>(params), sizeof(params));
+    file.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+    for (const auto* column : {&c.shuttle, &c.slot, &c.start, &c.end, &c.soc_start, &c.soc_end})
+        write_column(file, *column);
+    write_column(file, c.mode);
+    write_column(file, c.req_time);
+    for (const auto* column : {&c.req_id, &c.served_shuttle, &c.served_slot, &c.departure})
+        write_column(file, *column);
+    write_column(file, c.direction);
+    if (!file)
+        throw std::runtime_error("Error writing " + path);
+}
+
+void write_solution(const std::string& path, const ProblemConfig& cfg,
+                    const std::vector<DemandRequest>& demands, const Schedule& schedule) {
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0)
+        write_solution_binary(path, cfg, demands, schedule);
+    else
+        write_solution_json(path, cfg, demands, schedule);
+}
@@ -0,0 +1,284 @@
+#include "solver.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "heuristic.hpp"
+#include "lns.hpp"
+#include "mip.hpp"
+#include "portfolio.hpp"
+#include "presolve.hpp"
+#include "rolling.hpp"
+
+namespace {
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+IloCP::ParameterValues search_type_value(const std::string& name) {
+    std::string n = lower(name);
+    if (n == "depthfirst")      return IloCP::DepthFirst;
+    if (n == "restart")         return IloCP::Restart;
+    if (n == "multipoint")      return IloCP::MultiPoint;
+    if (n == "iterativediving") return IloCP::IterativeDiving;
+    if (n == "auto")            return IloCP::Auto;
+    // Restart search is CP Optimizer's large neighborhood search
+    if (n == "neighborhood")    return IloCP::Restart;
+    throw std::invalid_argument("Unknown search_type: " + name);
+}
+
+IloCP::ParameterValues verbosity_value(const std::string& name) {
+    std::string n = lower(name);
+    if (n == "quiet")   return IloCP::Quiet;
+    if (n == "terse")   return IloCP::Terse;
+    if (n == "normal")  return IloCP::Normal;
+    if (n == "verbose") return IloCP::Verbose;
+    throw std::invalid_argument("Unknown log_verbosity: " + name);
+}
+
+IloCP::ParameterValues parallel_mode_value(const std::string& name) {
+    std::string n = lower(name);
+    if (n == "deterministic") return IloCP::Deterministic;
+    if (n == "opportunistic") return IloCP::Opportunistic;
+    throw std::invalid_argument("Unknown parallel_mode: " + name);
+}
+
+const char* status_name(IloAlgorithm::Status status) {
+    switch (status) {
+        case IloAlgorithm::Feasible:   return "Feasible";
+        case IloAlgorithm::Optimal:    return "Optimal";
+        case IloAlgorithm::Infeasible: return "Infeasible";
+        case IloAlgorithm::Error:      return "Error";
+        default:                       return "Unknown";
+    }
+}
+
+// Records every new incumbent and bound improvement into the profiler's trace
+class TraceCallback : public IloCP::Callback {
+public:
+    explicit TraceCallback(Profiler& profiler) : profiler_(profiler) {}
+
+    void invoke(IloCP cp, IloCP::Callback::Reason reason) override {
+        if (reason == IloCP::Callback::Solution)
+            profiler_.add_trace_point(true, cp.getObjValue(), cp.getObjBound());
+        else if (reason == IloCP::Callback::ObjBound)
+            profiler_.add_trace_point(false, 0, cp.getObjBound());
+    }
+
+private:
+    Profiler& profiler_;
+};
+
+// CP and MIP results side by side; the MIP bounds are valid for the CP model
+void report_engine_comparison(const SolveResult& cp, const MipResult& mip, std::ostream& out) {
+    auto gap = [](double objective, double bound) {
+        return objective != 0 ? std::fabs(objective - bound) / std::fabs(objective) : 0.0;
+    };
+    out << "Engine comparison" << std::endl;
+    out << "  cp:  " << (cp.found ? "objective " + std::to_string(cp.objective) : std::string("no solution"))
+        << ", bound " << cp.bound << std::endl;
+    out << "  mip: " << (mip.found ? "objective " + std::to_string(mip.objective) : std::string("no solution"))
+        << ", bound " << mip.bound << ", LP bound " << mip.lp_bound << ", " << mip.solve_time << " s" << std::endl;
+    if (cp.found) {
+        double best_bound = std::max({cp.bound, mip.bound, mip.lp_bound});
+        out << "  certified gap of the CP solution: " << gap(cp.objective, best_bound) << std::endl;
+    }
+}
+
+// Empty schedule if nothing was found, and the elapsed time
+SolveResult& finish_result(SolveResult& result, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                           std::chrono::steady_clock::time_point t0) {
+    if (!result.found) {
+        result.schedule.shuttles.resize(cfg.num_shuttles);
+        result.schedule.served_by.assign(demands.size(), {-1, -1});
+    }
+    result.solve_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
+
+} // namespace
+
+void configure_solver(IloCP& cp, const ShuttleModel& sm, const ProblemConfig& cfg) {
+    IloEnv env = cp.getEnv();
+    IloSearchPhase scheduling_phase = IloSearchPhase(env, sm.all_intervals);
+
+    IloSearchPhaseArray phases(env);
+    phases.add(scheduling_phase);
+    if (sm.sequence)
+        phases.add(IloSearchPhase(env, sm.sequences));
+    //phases.add(IloSearchPhase(env, sm.assign_vars));
+
+    cp.setSearchPhases(phases);
+    cp.setParameter(IloCP::TimeLimit, cfg.time_limit);
+
+    cp.setParameter(IloCP::SearchType, search_type_value(cfg.search_type));
+    cp.setParameter(IloCP::LogVerbosity, verbosity_value(cfg.log_verbosity));
+    cp.setParameter(IloCP::ParallelMode, parallel_mode_value(cfg.parallel_mode));
+    if (cfg.workers > 0)
+        cp.setParameter(IloCP::Workers, cfg.workers);
+    if (cfg.fail_limit > 0)
+        cp.setParameter(IloCP::FailLimit, cfg.fail_limit);
+    if (cfg.branch_limit > 0)
+        cp.setParameter(IloCP::BranchLimit, cfg.branch_limit);
+    if (cfg.relative_gap >= 0)
+        cp.setParameter(IloCP::RelativeOptimalityTolerance, cfg.relative_gap);
+    cp.setParameter(IloCP::RandomSeed, cfg.random_seed);
+}
+
+void print_solve_report(const IloCP& cp, const ProblemConfig& cfg, std::ostream& out) {
+    // Concert only exposes counters summed over workers, so the per-worker
+    // figures are averages over the workers the search actually ran
+    IloInt workers = std::max<IloInt>(1, cp.getInfo(IloCP::EffectiveWorkers));
+    IloInt branches = cp.getInfo(IloCP::NumberOfBranches);
+    IloInt fails = cp.getInfo(IloCP::NumberOfFails);
+    IloInt choice_points = cp.getInfo(IloCP::NumberOfChoicePoints);
+
+    out << "Solve report" << std::endl;
+    out << "  status: " << status_name(cp.getStatus()) << std::endl;
+    if (cp.getStatus() == IloAlgorithm::Feasible || cp.getStatus() == IloAlgorithm::Optimal) {
+        double obj = cp.getObjValue();
+        double bound = cp.getObjBound();
+        out << "  objective: " << obj << ", bound: " << bound
+            << ", gap: " << (obj != 0 ? std::fabs(obj - bound) / std::fabs(obj) : 0.0) << std::endl;
+    }
+    out << "  workers: " << workers << " (" << cfg.parallel_mode << ", " << cfg.search_type << ")" << std::endl;
+    out << "  solve time: " << cp.getInfo(IloCP::SolveTime) << " s"
+        << ", extraction time: " << cp.getInfo(IloCP::ExtractionTime) << " s" << std::endl;
+    out << "  branches: " << branches << " (average " << branches / workers << " per worker)" << std::endl;
+    out << "  fails: " << fails << " (average " << fails / workers << " per worker)" << std::endl;
+    out << "  choice points: " << choice_points << " (average " << choice_points / workers << " per worker)" << std::endl;
+    out << "  memory: " << cp.getInfo(IloCP::MemoryUsage) / (1024 * 1024) << " MB" << std::endl;
+}
+
+SolveResult solve_problem(IloEnv env, const ProblemConfig& cfg, const std::vector<DemandRequest>& demands,
+                          std::ostream& log, Profiler* profiler, ModelCache* cache) {
+    auto t0 = std::chrono::steady_clock::now();
+    SolveResult result;
+
+    if (cfg.heuristic_only) {
+        // Greedy dispatch only, no CP solve
+        ScopedPhase phase(profiler, "greedy heuristic");
+        result.schedule = greedy_schedule(cfg, demands);
+        result.found = true;
+    } else if (cfg.rolling_horizon) {
+        ScopedPhase phase(profiler, "rolling horizon");
+        result.schedule = solve_rolling_horizon(cfg, demands, log);
+        result.found = true;
+    } else if (cfg.engine == "mip") {
+        ScopedPhase phase(profiler, "mip");
+        MipResult mip = solve_mip(env, cfg, demands, log);
+        result.found = result.has_objective = mip.found;
+        result.objective = mip.objective;
+        result.has_bound = true;
+        result.bound = std::max(mip.bound, mip.lp_bound);
+        result.schedule = mip.schedule;
+    } else if (cfg.portfolio) {
+        ScopedPhase phase(profiler, "portfolio");
+        result = solve_portfolio(cfg, demands, log);
+    } else {
+        // Bound the objective first: an infeasible fleet or a greedy schedule that
+        // keeps the model's rules and already meets the bound needs no search
+        PresolveBounds bounds;
+        Schedule greedy;
+        bool greedy_optimal = false;
+        if (cfg.presolve) {
+            ScopedPhase phase(profiler, "presolve");
+            bounds = presolve_bounds(cfg, demands);
+            print_presolve_report(bounds, log);
+            if (!bounds.feasible) {
+                log << "Presolve: no feasible schedule, skipping the CP solve." << std::endl;
+                return finish_result(result, cfg, demands, t0);
+            }
+            greedy = greedy_schedule(cfg, demands);
+            double greedy_objective = schedule_objective(greedy, demands);
+            std::string violation = schedule_violation(cfg, demands, greedy);
+            if (!violation.empty())
+                log << "Presolve: greedy schedule breaks the model (" << violation << ")." << std::endl;
+            greedy_optimal = violation.empty() && greedy_objective <= bounds.objective + 1e-6;
+            // An exported model needs the model built: CP then stops at the starting point
+            if (greedy_optimal && cfg.export_model.empty()) {
+                log << "Presolve: greedy schedule meets the bound (" << greedy_objective
+                    << "), skipping the CP solve." << std::endl;
+                result.found = result.has_objective = result.has_bound = true;
+                result.objective = greedy_objective;
+                result.bound = bounds.objective;
+                result.schedule = greedy;
+                return finish_result(result, cfg, demands, t0);
+            }
+        } else if (cfg.warm_start) {
+            greedy = greedy_schedule(cfg, demands);
+        }
+
+        // Create the model
+        ScopedPhase build_phase(profiler, "build model");
+        ShuttleModel sm = build_model(env, cfg, demands, {}, profiler, cache);
+        build_phase.stop();
+        if (sm.aggregated)
+            log << "Aggregated " << demands.size() << " requests into " << sm.groups.size() << " demand groups." << std::endl;
+        log << "Created " << sm.assign_index.arcs.size() << " assignment arcs (dense model: "
+            << size_t(cfg.num_shuttles) * cfg.max_tasks * sm.windows.size() << ")." << std::endl;
+
+        // The search stops as soon as an incumbent reaches the presolve bound
+        if (cfg.presolve)
+            sm.model.add(sm.objective.getExpr() >= bounds.objective);
+
+        IloCP cp(sm.model);
+        configure_solver(cp, sm, cfg);
+        cp.setOut(log);
+        if (!cfg.export_model.empty()) {
+            cp.dumpModel(cfg.export_model.c_str());
+            log << "Wrote the CP model to " << cfg.export_model << "." << std::endl;
+        }
+
+        // Start the search from the greedy schedule
+        if (cfg.warm_start || greedy_optimal) {
+            ScopedPhase phase(profiler, "warm start");
+            cp.setStartingPoint(make_starting_point(env, sm, greedy));
+        }
+
+        std::unique_ptr<TraceCallback> trace;
+        if (profiler) {
+            trace.reset(new TraceCallback(*profiler));
+            cp.addCallback(trace.get());
+        }
+        ScopedPhase solve_phase(profiler, cfg.lns ? "lns" : "solve");
+
+        if (cfg.lns) {
+            IloSolution incumbent(env);
+            if (run_lns(cp, sm, cfg, incumbent, result.objective, log)) {
+                result.found = result.has_objective = true;
+                result.schedule = extract_schedule(incumbent, sm, demands.size());
+            }
+        } else {
+            if (cp.solve()) {
+                result.found = result.has_objective = true;
+                result.objective = cp.getObjValue();
+                result.has_bound = true;
+                result.bound = cp.getObjBound();
+                result.schedule = extract_schedule(cp, sm, demands.size());
+            }
+            print_solve_report(cp, cfg, log);
+        }
+        solve_phase.stop();
+        if (trace)
+            cp.removeCallback(trace.get());
+
+        if (cfg.engine == "compare") {
+            ScopedPhase phase(profiler, "mip");
+            MipResult mip = solve_mip(env, cfg, demands, log);
+            report_engine_comparison(result, mip, log);
+            // The MIP relaxes the CP model, so its bounds also bound the CP objective
+            result.has_bound = true;
+            result.bound = std::max({result.bound, mip.bound, mip.lp_bound});
+        }
+    }
+
+    return finish_result(result, cfg, demands, t0);
+}
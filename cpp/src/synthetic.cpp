@@ -0,0 +1,33 @@
+#include "synthetic.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+std::vector<DemandRequest> generate_demand(const SyntheticDemandSpec& spec) {
+    std::mt19937 rng(spec.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> uniform_slot(spec.first_slot, spec.last_slot);
+    double span = spec.last_slot - spec.first_slot;
+
+    std::vector<DemandRequest> demands;
+    demands.reserve(spec.passengers);
+    for (int p = 0; p < spec.passengers; ++p) {
+        Direction direction = unit(rng) < spec.return_share ? Direction::Return : Direction::Outbound;
+        int slot;
+        if (unit(rng) < spec.peak_share) {
+            double centre = spec.first_slot + span * (direction == Direction::Outbound ? spec.outbound_peak : spec.return_peak);
+            std::normal_distribution<double> peak(centre, spec.peak_width);
+            slot = std::clamp(int(std::lround(peak(rng))), spec.first_slot, spec.last_slot);
+        } else {
+            slot = uniform_slot(rng);
+        }
+        demands.push_back({0, direction, double(slot)});
+    }
+
+    std::stable_sort(demands.begin(), demands.end(),
+                     [](const DemandRequest& a, const DemandRequest& b) { return a.time < b.time; });
+    for (size_t d = 0; d < demands.size(); ++d)
+        demands[d].req_id = int(d);
+    return demands;
+}
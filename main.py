@@ -12,15 +12,25 @@ def main():
     with open("data/config.yaml", "r") as f:
         config = yaml.safe_load(f)
 
-    # Load data
-    demand_df = load_demand(config["data"]["demand_file"], config["time_res"])
-    demand_df.to_csv("data/demand.csv", index=False)
+    # In process when the Python module is built (make python in cpp/)
+    try:
+        from utils.native import solve
+    except ImportError:
+        solve = None
 
-    # Call the C++ solver
+    if solve is not None:
+        demand_df = load_demand(config["data"]["demand_file"], config["time_res"])
+        result = solve("data/config.yaml", demand_df)
+        requests = result["requests"]
+        print(f"Objective: {result['objective']}, served {int((requests['served_shuttle'] >= 0).sum())}"
+              f" of {len(requests)} requests in {result['solve_time']:.1f} s")
+        return
+
+    # Call the C++ solver; it reads the slot,direction,passengers file directly
     subprocess.run([
         "./cpp/solver",
         "data/config.yaml",
-        "data/demand.csv"
+        config["data"]["demand_file"],
         "solution.json"
     ], check=True)
 
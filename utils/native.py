@@ -0,0 +1,43 @@
+import os
+import sys
+
+import numpy as np
+import pandas as pd
+
+# shuttle_solver is built next to the solver binary by `make python` in cpp/
+sys.path.append(os.path.join(os.path.dirname(__file__), '..', 'cpp'))
+import shuttle_solver
+
+
+def solve(config_path: str, demand_df: pd.DataFrame, heuristic_only: bool = False, verbose: bool = False):
+    """
+    Solves one instance in process with the C++ solver.
+
+    Args:
+        config_path (str): Solver configuration (config.yaml)
+        demand_df (DataFrame): One row per request with req_id, direction (O/R or
+            OUTBOUND/RETURN) and time in model slots, as returned by parser.load_demand
+        heuristic_only (bool): Greedy schedule only, no CP solve
+        verbose (bool): Print the solver log to stderr
+
+    Returns:
+        result (dict): found, objective, bound and solve_time, plus the schedule
+            as two DataFrames: tasks (shuttle, slot, start, end, soc_start,
+            soc_end, mode) and requests (req_id, req_time, direction,
+            served_shuttle, served_slot, departure; -1 if unmet)
+    """
+    # float64 time and int64 req_id columns are passed without a copy
+    direction = (demand_df["direction"].str.strip().str[0].str.upper() == "R").to_numpy(np.uint8)
+    time = demand_df["time"].to_numpy(np.float64)
+    req_id = demand_df["req_id"].to_numpy()
+
+    result = shuttle_solver.solve(config_path, direction, time, req_id,
+                                  heuristic_only=heuristic_only, verbose=verbose)
+
+    tasks = pd.DataFrame({name: np.asarray(col) for name, col in result["tasks"].items()})
+    tasks["mode"] = pd.Categorical.from_codes(tasks["mode"], categories=list(result["modes"]))
+    requests = pd.DataFrame({name: np.asarray(col) for name, col in result["requests"].items()})
+    requests["direction"] = np.where(requests["direction"] == 0, "O", "R")
+    result["tasks"] = tasks
+    result["requests"] = requests
+    return result
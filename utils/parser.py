@@ -13,6 +13,10 @@ def load_demand(filepath: str, time_res) -> pd.DataFrame:
     """
     df = pd.read_csv(filepath)
 
+    # Already one row per request: req_id, direction, time (model slots)
+    if {"req_id", "direction", "time"}.issubset(df.columns):
+        return df.sort_values("time").reset_index(drop=True)
+
     required_cols = {"slot", "passengers", "direction"}
     if not required_cols.issubset(df.columns):
         raise ValueError(f"Demand file must include columns: {required_cols}")
@@ -83,6 +83,91 @@ def extract_schedule(solution_dict):
     return schedule_df
 
 
+TASK_MODES = ["OUT", "RET", "CRGp", "CRGf", "END"]
+
+
+def load_solution(path):
+    """
+    Loads a solution written by the C++ solver (solution.json, or the columnar
+    .bin format) into a Gantt-compatible schedule DataFrame.
+
+    Returns:
+        schedule_df (pd.DataFrame): one row per task with its passengers and
+        battery level before/after, as expected by plot_gantt
+    """
+    if str(path).endswith(".bin"):
+        return _load_solution_binary(path)
+
+    import json
+    with open(path) as f:
+        solution = json.load(f)
+
+    schedule = []
+    for shuttle in solution["shuttles"]:
+        for task in shuttle["tasks"]:
+            schedule.append({
+                "shuttle": shuttle["id"],
+                "task_index": task["slot"],
+                "task_type": task["task"],
+                "start": task["start"],
+                "end": task["end"],
+                "duration": task["duration"],
+                "passengers": task["passengers"],
+                "n_passengers": len(task["passengers"]),
+                "battery_start": task["soc_start"],
+                "battery_end": task["soc_end"]
+            })
+    return pd.DataFrame(schedule)
+
+
+def _load_solution_binary(path):
+    import numpy as np
+
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"MBSL":
+        raise ValueError(f"{path} is not a solver binary solution")
+    offset = 8 + 8 * 4
+    num_tasks, num_requests = np.frombuffer(data, np.uint64, 2, offset)
+    offset += 16
+
+    def column(dtype, count):
+        nonlocal offset
+        values = np.frombuffer(data, dtype, int(count), offset)
+        offset += values.nbytes
+        return values
+
+    tasks = {name: column(np.int32, num_tasks)
+             for name in ["shuttle", "slot", "start", "end", "soc_start", "soc_end"]}
+    tasks["mode"] = column(np.uint8, num_tasks)
+    column(np.float64, num_requests)  # req_time
+    req_id = column(np.int32, num_requests)
+    served_shuttle = column(np.int32, num_requests)
+    served_slot = column(np.int32, num_requests)
+
+    passengers = {}
+    for d in np.flatnonzero(served_shuttle >= 0):
+        passengers.setdefault((served_shuttle[d], served_slot[d]), []).append(int(req_id[d]))
+
+    schedule = []
+    for k in range(int(num_tasks)):
+        key = (tasks["shuttle"][k], tasks["slot"][k])
+        on_board = passengers.get(key, [])
+        schedule.append({
+            "shuttle": int(tasks["shuttle"][k]),
+            "task_index": int(tasks["slot"][k]),
+            "task_type": TASK_MODES[tasks["mode"][k]],
+            "start": int(tasks["start"][k]),
+            "end": int(tasks["end"][k]),
+            "duration": int(tasks["end"][k] - tasks["start"][k]),
+            "passengers": on_board,
+            "n_passengers": len(on_board),
+            "battery_start": int(tasks["soc_start"][k]),
+            "battery_end": int(tasks["soc_end"][k])
+        })
+    return pd.DataFrame(schedule)
+
+
 def process_schedule_df(schedule_df, time_res):
     # 1. Convert time units to clock time starting at 07:00
     base_time = datetime.strptime("07:00", "%H:%M")